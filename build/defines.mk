@@ -22,6 +22,10 @@ ifeq ($(OPENMP),1)
 CXXFLAGS += -fopenmp -DOPENMP
 endif
 
+ifeq ($(SIMD),1)
+CXXFLAGS += -mavx2 -mfma
+endif
+
 ifeq ($(PYBIND),1)
 DEPEND_UBUNTU += python3-dev python3 python3-numpy python3-pip python3-distutils
 #pybind11-dev NO! don't use the ubuntu package. Instead use:
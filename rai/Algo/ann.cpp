@@ -8,37 +8,147 @@
 
 #include "ann.h"
 #include "algos.h"
+#include "../Core/thread.h"
 
-#ifdef RAI_ANN
+#include <algorithm>
 
-#include <ANN/ANN.h>
+//===========================================================================
+
+/// a static kd-tree over a subset of the rows of X, stored implicitly: the node of a range [lo,hi) is its
+/// median mid=(lo+hi)/2, with idx(mid) the split point and dim(mid) the split dimension
+struct KdTree {
+  uintA idx;  ///< rows of X, in tree order
+  uintA dim;  ///< split dimension of each node
+  static const uint leafSize=8;
+
+  uint size() const { return idx.N; }
+
+  void build(const arr& X) {
+    dim.resize(idx.N).setZero();
+    build(X, 0, idx.N);
+  }
+
+  void build(const arr& X, uint lo, uint hi) {
+    if(hi-lo<=leafSize) return;
+    //split along the dimension of largest spread
+    uint D=X.d1, s=0;
+    double maxSpread=-1.;
+    for(uint d=0; d<D; d++) {
+      double a=X.p[idx.p[lo]*D+d], b=a;
+      for(uint i=lo+1; i<hi; i++) { double v=X.p[idx.p[i]*D+d]; if(v<a) a=v; if(v>b) b=v; }
+      if(b-a>maxSpread) { maxSpread=b-a; s=d; }
+    }
+    uint mid=(lo+hi)/2;
+    std::nth_element(idx.p+lo, idx.p+mid, idx.p+hi, [&X, D, s](uint i, uint j) { return X.p[i*D+s] < X.p[j*D+s]; });
+    dim.p[mid]=s;
+    build(X, lo, mid);
+    build(X, mid+1, hi);
+  }
+};
+
+/// the current k best candidates, sorted by distance
+struct KBest {
+  double* dists;
+  int* idx;
+  uint k, n=0;
+
+  double worst() const { return n<k ? INFINITY : dists[k-1]; }
+
+  void insert(double d, int i) {
+    if(d>=worst()) return;
+    uint j = (n<k ? n++ : k-1);
+    for(; j>0 && dists[j-1]>d; j--) { dists[j]=dists[j-1]; idx[j]=idx[j-1]; }
+    dists[j]=d;  idx[j]=i;
+  }
+};
+
+static double sqrDist(const double* a, const double* b, uint D) {
+  double s=0.;
+  for(uint d=0; d<D; d++) { double z=a[d]-b[d]; s+=z*z; }
+  return s;
+}
+
+static void searchKdTree(const KdTree& T, const arr& X, const double* x, KBest& best, double epsFactor, uint lo, uint hi) {
+  uint D=X.d1;
+  if(hi-lo<=KdTree::leafSize) {
+    for(uint i=lo; i<hi; i++) { uint r=T.idx.p[i]; best.insert(sqrDist(X.p+r*D, x, D), r); }
+    return;
+  }
+  uint mid=(lo+hi)/2, r=T.idx.p[mid], s=T.dim.p[mid];
+  best.insert(sqrDist(X.p+r*D, x, D), r);
+  double diff = x[s] - X.p[r*D+s];
+  if(diff<0.) {
+    searchKdTree(T, X, x, best, epsFactor, lo, mid);
+    if(epsFactor*diff*diff < best.worst()) searchKdTree(T, X, x, best, epsFactor, mid+1, hi);
+  } else {
+    searchKdTree(T, X, x, best, epsFactor, mid+1, hi);
+    if(epsFactor*diff*diff < best.worst()) searchKdTree(T, X, x, best, epsFactor, lo, mid);
+  }
+}
 
 struct sANN {
-  ANNkd_tree* tree=0;
-  //PartialLeastSquares pls;
-  rai::Array<double*> cpointers;
-  uint treeSize;   //for how many entries in X have we build the tree?
-  void clear() { if(tree) delete tree;   tree=nullptr;  cpointers.clear();  treeSize=0; }
+  std::vector<KdTree> forest; //trees of decreasing size
+  uint bufferStart=0;         //rows of X from here on are not in any tree
+  //X as indexed: to detect changes from outside (reallocated, shrunk, reshaped, or replaced -- the latter checked on a few sample rows)
+  const double* Xp=nullptr;
+  uint Xd1=0;
+  uintA sampleRows;
+  arr samples;
+
+  void clear() { forest.clear();  bufferStart=0;  Xp=nullptr;  Xd1=0;  sampleRows.clear();  samples.clear(); }
+
+  void snapshot(const arr& X) {
+    Xp=X.p;  Xd1=X.d1;
+    uint n=rai::MIN(bufferStart, 8u);
+    sampleRows.resize(n);
+    samples.resize(n, X.d1);
+    for(uint i=0; i<n; i++) {
+      sampleRows(i) = (n>1 ? i*(bufferStart-1)/(n-1) : 0);
+      memmove(samples.p+i*X.d1, X.p+sampleRows(i)*X.d1, X.d1*sizeof(double));
+    }
+  }
+
+  bool isValid(const arr& X) const {
+    if(X.p!=Xp || X.d1!=Xd1 || X.d0<bufferStart) return false;
+    for(uint i=0; i<sampleRows.N; i++) if(memcmp(samples.p+i*X.d1, X.p+sampleRows(i)*X.d1, X.d1*sizeof(double))) return false;
+    return true;
+  }
+
+  void merge(const arr& X, uint n) { //merge the oldest n buffered rows, and all trees not larger, into a new tree
+    KdTree T;
+    uint m=n;
+    int t=forest.size();
+    while(t>0 && forest[t-1].size()<=m) { t--; m+=forest[t].size(); }
+    T.idx.resize(m);
+    uint j=0;
+    for(uint l=t; l<forest.size(); l++) for(uint i:forest[l].idx) T.idx.p[j++]=i;
+    for(uint i=0; i<n; i++) T.idx.p[j++]=bufferStart+i;
+    T.build(X);
+    forest.resize(t);
+    forest.push_back(std::move(T));
+    bufferStart += n;
+  }
+
+  void query(double* dists, int* idx, uint k, const arr& X, const double* x, double eps) const {
+    KBest best{dists, idx, k};
+    double epsFactor=(1.+eps)*(1.+eps);
+    for(const KdTree& T:forest) searchKdTree(T, X, x, best, epsFactor, 0, T.size());
+    for(uint i=bufferStart; i<X.d0; i++) best.insert(sqrDist(X.p+i*X.d1, x, X.d1), i);
+  }
 };
 
 ANN::ANN() {
-  bufferSize = 1 <<10;
+  bufferSize = 1 <<6;
   self = make_unique<sANN>();
-  self->tree = 0;
-  self->treeSize = 0;
 }
 
 ANN::ANN(const ANN& ann) {
-  bufferSize = 1 <<10;
+  bufferSize = ann.bufferSize;
   self = make_unique<sANN>();
-  self->tree = 0;
-  self->treeSize = 0;
   setX(ann.X);
 }
 
 ANN::~ANN() {
-  self->clear();
-  //annClose(); //mt09-07-29 this would close down the ANN lib completely
 }
 
 void ANN::clear() {
@@ -49,63 +159,40 @@ void ANN::clear() {
 void ANN::setX(const arr& _XX) {
   self->clear();
   X=_XX;
+  calculate();
 }
 
 void ANN::append(const arr& x) {
-  double* p=X.p;
+  bool valid = self->isValid(X);
   X.append(x);
   if(X.N==x.d0) X.reshape(1, x.d0);
-  if(X.p!=p) self->clear(); //when the memory location changed clear the tree! (implies recomputation)
+  if(!valid) { calculate(); return; }
+  self->Xp=X.p;  self->Xd1=X.d1; //X may have been reallocated: fine, as trees store row indices
+  if(X.d0-self->bufferStart>=bufferSize) {
+    self->merge(X, X.d0-self->bufferStart);
+    self->snapshot(X);
+  }
 }
 
 void ANN::calculate() {
-  if(self->treeSize == X.d0) return;
   self->clear();
-  X.getCarray(self->cpointers);
-  self->tree = new ANNkd_tree(self->cpointers.p, X.d0, X.d1);
-  self->treeSize = X.d0;
+  if(X.d0) self->merge(X, X.d0);
+  self->snapshot(X);
 }
 
 void ANN::getkNN(arr& dists, intA& idx, const arr& x, uint k, double eps, bool verbose) {
   CHECK_GE(X.d0, k, "data has less (" <<X.d0 <<") than k=" <<k <<" points");
   CHECK_EQ(x.N, X.d1, "query point has wrong dimension. x.N=" << x.N << ", X.d1=" << X.d1);
+  if(!self->isValid(X)) calculate(); //X was changed from outside
 
-  if(X.d0-self->treeSize>bufferSize) {
-    if(verbose) std::cout <<"ANN recomputing: X.d0=" <<X.d0 <<" treeSize=" <<self->treeSize <<std::endl;
-    calculate();
-  }
-  uint restStartsAt;
-  if(self->treeSize>=k) {
-    dists.resize(k);
-    idx.resize(k);
-    self->tree->annkSearch(x.p, k, idx.p, dists.p, eps);
-    restStartsAt=self->treeSize;
-  } else {
-    dists.clear();
-    idx.clear();
-    restStartsAt=0;
-  }
-
-  //now check if in the rest of X there are even nearer points
-  for(uint i=restStartsAt; i<X.d0; i++) {
-    for(uint j=0; j<=idx.N && j<k; j++) {
-      double d=sqrDistance(X[i], x);
-      if(j==idx.N || d < dists(j)) {
-        idx.insert(j, i);
-        dists.insert(j, d);
-        break;
-      }
-    }
-  }
-  if(idx.N>k) {
-    idx.resizeCopy(k);
-    dists.resizeCopy(k);
-  }
+  dists.resize(k);
+  idx.resize(k);
+  self->query(dists.p, idx.p, k, X, x.p, eps);
 
   if(verbose) {
     std::cout
         <<"ANN query:"
-        <<"\n data size = " <<X.d0 <<"  data dim = " <<X.d1 <<"  treeSize = " <<self->treeSize
+        <<"\n data size = " <<X.d0 <<"  data dim = " <<X.d1 <<"  #trees = " <<self->forest.size() <<"  buffered = " <<X.d0-self->bufferStart
         <<"\n query point " <<x
         <<"\n found neighbors:\n";
     for(uint i=0; i<idx.N; i++) {
@@ -118,6 +205,24 @@ void ANN::getkNN(arr& dists, intA& idx, const arr& x, uint k, double eps, bool v
   }
 }
 
+void ANN::getkNNs(arr& dists, intA& idx, const arr& Q, uint k, double eps, ThreadPool* pool) {
+  CHECK_GE(X.d0, k, "data has less (" <<X.d0 <<") than k=" <<k <<" points");
+  CHECK_EQ(Q.nd, 2, "");
+  CHECK_EQ(Q.d1, X.d1, "query points have wrong dimension");
+  if(!self->isValid(X)) calculate(); //X was changed from outside (before any threads start)
+
+  dists.resize(Q.d0, k);
+  idx.resize(Q.d0, k);
+  if(!pool || pool->size()<2) {
+    for(uint i=0; i<Q.d0; i++) self->query(dists.p+i*k, idx.p+i*k, k, X, Q.p+i*Q.d1, eps);
+  } else {
+    uint n = rai::MIN(Q.d0, 8*pool->size()), chunk = (Q.d0+n-1)/n;
+    pool->parallelFor(n, [&](uint c, uint) {
+      for(uint i=c*chunk; i<Q.d0 && i<(c+1)*chunk; i++) self->query(dists.p+i*k, idx.p+i*k, k, X, Q.p+i*Q.d1, eps);
+    });
+  }
+}
+
 uint ANN::getNN(const arr& x, double eps, bool verbose) {
   intA idx;
   arr dists;
@@ -137,20 +242,3 @@ void ANN::getkNN(arr& xx, const arr& x, uint k, double eps, bool verbose) {
   xx.resize(idx.N, X.d1);
   for(uint i=0; i<idx.N; i++) xx[i]=X[idx(i)];
 }
-
-#else //RAI_ANN
-
-struct sANN {};
-
-ANN::ANN() { NICO }
-ANN::~ANN() { NICO }
-
-void ANN::calculate() { NICO }
-void ANN::setX(const arr& _XX) { NICO }
-void ANN::append(const arr& x) { NICO }
-uint ANN::getNN(const arr& x, double eps, bool verbose) { NICO }
-void ANN::getkNN(intA& idx, const arr& x, uint k, double eps, bool verbose) { NICO }
-void ANN::getkNN(arr& sqrDists, intA& idx, const arr& x, uint k, double eps, bool verbose) { NICO }
-void ANN::getkNN(arr& X, const arr& x, uint k, double eps, bool verbose) { NICO }
-
-#endif
@@ -15,23 +15,36 @@
 // Approximate Nearest Neighbor Search (kd-tree)
 //
 
+struct ThreadPool;
+
+/// (approximate) nearest neighbors in the rows of X. Points are held in a forest of static kd-trees of
+/// geometrically decreasing size (the logarithmic method), plus a small buffer of recently appended points that
+/// is scanned linearly: append() pushes into the buffer, and a full buffer is merged with all smaller trees into
+/// a new tree -- each point is rebuilt O(log n) times, giving amortized O(log^2 n) insertion, and queries visit
+/// O(log n) trees. X may be changed from outside (shrunk, reallocated, replaced): queries detect this (by size,
+/// memory location and a few sample rows) and rebuild -- so queries are not const and may only run concurrently when X
+/// is unchanged since the last setX/append/calculate; after editing single rows of X in place, call calculate().
+/// getkNNs does this check once and then splits the batch across the pool's threads.
 struct ANN {
   unique_ptr<struct sANN> self;
 
   arr X;       //the data set for which a ANN tree is build
-  uint bufferSize; //a tree is only rebuild if there are more than 'buffer' new points appended [default: 20]
+  uint bufferSize; //size of the linearly scanned buffer of appended points before they are merged into the forest [default: 64]
 
   ANN();
   ANN(const ANN& ann);
   ~ANN();
 
   void clear();              //clears the tree and X
-  void setX(const arr& _X);  //set X
+  void setX(const arr& _X);  //set X (and build a single tree)
   void append(const arr& x); //append to X
-  void calculate();          //compute a tree for all of X
+  void calculate();          //compute a single tree for all of X
 
   uint getNN(const arr& x, double eps=.0, bool verbose=false);
   void getkNN(intA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
   void getkNN(arr& sqrDists, intA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
   void getkNN(arr& X, const arr& x, uint k, double eps=.0, bool verbose=false);
+
+  /// batched queries: the k nearest neighbors of each row of Q, as (Q.d0,k) arrays; split across the pool's threads if given
+  void getkNNs(arr& sqrDists, intA& idx, const arr& Q, uint k, double eps=.0, ThreadPool* pool=nullptr);
 };
@@ -35,10 +35,11 @@ struct AStarOnGraph {
     }
     //pop
     NodeType* node =  queue.pop();
-    //loop/graph check
+    //loop/graph check -- also skips outdated queue entries of nodes that were re-added with lower cost (lazy deletion)
     if(!node->astar_isClosed) {
       //goal check
       if(node==goal) return true;
+      node->astar_isClosed = true;
       //expand
       rai::Array<NodeType*> N = getNeighbors(node);
       for(NodeType* child:N) {
@@ -47,6 +48,7 @@ struct AStarOnGraph {
           if(cost < child->astar_g) {
             child->astar_g = cost;
             child->astar_parent = node;
+            child->astar_isClosed = false; //reopen (only happens for inconsistent heuristics)
             double f = child->astar_g + child->astar_heuristic(goal);
             queue.add(f, child, true);
           }
@@ -13,9 +13,11 @@
 template<class T> struct PriorityQueueEntry {
   double p;
   T x;
+  int64_t tie; ///< insertion stamp that breaks ties between equal p (negative for LIFO, positive for FIFO insertions)
 
   void write(std::ostream& os) const { os <<'[' <<p <<": " <<*x <<']'; }
   static bool cmp(const PriorityQueueEntry<T>& a, const PriorityQueueEntry<T>& b);
+  static bool less(const PriorityQueueEntry<T>& a, const PriorityQueueEntry<T>& b) { return a.p < b.p || (a.p==b.p && a.tie < b.tie); }
 };
 
 template<class T> stdOutPipe(PriorityQueueEntry<T>)
@@ -29,28 +31,72 @@ template<class T> bool operator<=(const PriorityQueueEntry<T>& a, const Priority
   return a.p <= b.p;
 }
 
+/// a min-priority queue as binary heap (stored in the array itself, in heap order, not sorted): add and pop are O(log N).
+/// Entries with equal priority are popped in the same order as if they had been inserted into a sorted list:
+/// 'fromBackIfEqual=true' behind all equal ones (FIFO, breadth first), otherwise in front of them (LIFO, depth first).
+/// There is no decrease-key; instead, re-add an element with its new priority and skip the outdated
+/// entries when they are popped (lazy deletion), e.g., via a 'closed' flag or by comparing the popped priority.
 template<class T> struct PriorityQueue : rai::Array<PriorityQueueEntry<T>> {
+  typedef rai::Array<PriorityQueueEntry<T>> Base;
+  int64_t stamp=0;
+
   PriorityQueue() {
-    rai::Array<PriorityQueueEntry<T>>::memMove = true;
+    Base::memMove = true;
   }
 
   void add(double p, const T& x, bool fromBackIfEqual=false) { //'fromBack=true' makes it a FIFO (breadth first search); otherwise LIFO (depth first search)
-    PriorityQueueEntry<T> e = {p, x};
-    rai::Array<PriorityQueueEntry<T>>::insertInSorted(e, PriorityQueueEntry<T>::cmp, fromBackIfEqual);
+    stamp++;
+    PriorityQueueEntry<T> e = {p, x, fromBackIfEqual ? stamp : -stamp};
+    Base::append(e);
+    siftUp(Base::N-1);
   }
 
-  T pop() {
-    T x=rai::Array<PriorityQueueEntry<T>>::first().x;
-    rai::Array<PriorityQueueEntry<T>>::remove(0);
+  const PriorityQueueEntry<T>& top() const { CHECK(Base::N, "queue is empty"); return Base::p[0]; }
+
+  T pop(double* p=nullptr) {
+    CHECK(Base::N, "queue is empty");
+    if(p) *p = Base::p[0].p;
+    T x = Base::p[0].x;
+    Base::p[0] = Base::p[Base::N-1];
+    Base::resizeCopy(Base::N-1);
+    if(Base::N) siftDown(0);
     return x;
   }
 
-  //  void add_replace(double p, const T& x){
-  //    PriorityQueueEntry<T> e = {p, x};
-  //    uint pos = rankInSorted(e, cmp_PriorityQueueEntry);
-  //    PriorityQueueEntry<T>& e_after = elem(pos);
-  //    if(e_after.x==e.x){
-  //      if(e_after)
-  //      e_after.p =
-  //  }
+  void clear() { Base::clear(); stamp=0; }
+
+  /// a copy of all entries in pop order (e.g. for reporting)
+  Base sorted() const {
+    Base S = *this;
+    S.sort(PriorityQueueEntry<T>::less);
+    return S;
+  }
+
+ private:
+  void siftUp(uint i) {
+    PriorityQueueEntry<T>* h = Base::p;
+    PriorityQueueEntry<T> e = h[i];
+    while(i) {
+      uint parent = (i-1)/2;
+      if(PriorityQueueEntry<T>::less(h[parent], e)) break;
+      h[i] = h[parent];
+      i = parent;
+    }
+    h[i] = e;
+  }
+
+  void siftDown(uint i) {
+    PriorityQueueEntry<T>* h = Base::p;
+    uint n = Base::N;
+    PriorityQueueEntry<T> e = h[i];
+    for(;;) {
+      uint child = 2*i+1;
+      if(child>=n) break;
+      if(child+1<n && PriorityQueueEntry<T>::less(h[child+1], h[child])) child++;
+      if(PriorityQueueEntry<T>::less(e, h[child])) break;
+      h[i] = h[child];
+      i = child;
+    }
+    h[i] = e;
+  }
 };
@@ -22,6 +22,8 @@ RRT::RRT(const arr& q0, double _stepsize) {
   self->parent.append(0);    //q has itself as parent
   self->stepsize = _stepsize;
 }
+RRT::~RRT() {
+}
 double RRT::getProposalTowards(arr& proposal, const arr& q) {
   //find NN
   self->nearest=self->ann.getNN(q);
@@ -16,6 +16,7 @@ struct RRT {
 
  public:
   RRT(const arr& q0, double _stepsize);
+  ~RRT();
   double getProposalTowards(arr& proposal, const arr& q);
   void add(const arr& q);
 
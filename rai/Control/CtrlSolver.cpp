@@ -16,6 +16,22 @@ CtrlSolver::CtrlSolver(const rai::Configuration& _C, double _tau, uint k_order)
   komo.setModel(_C, true);
   komo.setTiming(1., 1, _tau, k_order);
   komo.setupPathConfig();
+
+  warmStart = rai::getParameter<bool>("CtrlSolver/warmStart", true);
+  realtime = rai::getParameter<bool>("CtrlSolver/realtime", false);
+  komo.opt.reuseSolver = warmStart;
+  komo.opt.verbose=0;
+
+  opt.stopTolerance = 1e-4;
+  opt.stopGTolerance = 1e-4;
+  opt.stopIters = 20;
+//  opt.nonStrictSteps=-1;
+//  opt.maxStep = .1; //*tau; //maxVel*tau;
+  opt.damping = 1e-1;
+  if(realtime) {
+    opt.stopIters = rai::getParameter<int>("CtrlSolver/maxIters", 5);
+    opt.stopOuters = rai::getParameter<int>("CtrlSolver/maxOuters", 2);
+  }
 }
 
 CtrlSolver::~CtrlSolver(){
@@ -106,6 +122,7 @@ void CtrlSolver::update(const arr& q_real, const arr& qDot_real, rai::Configurat
 }
 
 void CtrlSolver::report(std::ostream& os) {
+  if(realtime) optReport = komo.getReport(false);
   os <<"    control objectives:" <<endl;
   for(auto& o: objectives) o->reportState(os);
   os <<"    optimization result:" <<endl;
@@ -121,29 +138,40 @@ arr CtrlSolver::solve() {
   q += M.inverseKinematics(objectives, NoArr, {});
   return q;
 #elif 1
-  komo.clearObjectives();
+  //-- rebuild the komo problem only if the active objectives changed; otherwise komo re-solves in its
+  //   persistent workspace, warm started from the last primal and dual solution
+  bool changed = !warmStart;
+  uint n=0;
   for(auto& o: objectives) if(o->active){
-    komo.addObjective({}, o->feat, {}, o->type);
+    if(n>=komoObjectives.N || komoObjectives.elem(n)!=o) changed=true;
+    n++;
   }
-  rai::OptOptions opt;
-  opt.stopTolerance = 1e-4;
-  opt.stopGTolerance = 1e-4;
-  opt.stopIters = 20;
-//  opt.nonStrictSteps=-1;
-//  opt.maxStep = .1; //*tau; //maxVel*tau;
-  opt.damping = 1e-1;
-  komo.opt.verbose=0;
+  if(n!=komoObjectives.N) changed=true;
+  if(changed){
+    komo.clearObjectives();
+    komoObjectives.clear();
+    for(auto& o: objectives) if(o->active){
+      komo.addObjective({}, o->feat, {}, o->type);
+      komoObjectives.append(o);
+    }
+  }
+
   komo.opt.animateOptimization=animate;
   komo.optimize(0., opt);
-  optReport = komo.getReport(false);
-  if(optReport.get<double>("sos")>1.1
-     || optReport.get<double>("eq")>.01
-     || optReport.get<double>("ineq")>.01){
+  sos = komo.sos;  eq = komo.eq;  ineq = komo.ineq;
+  if(realtime){
+    //never block the control loop: the caller checks sos/eq/ineq
+  }else{
+    optReport = komo.getReport(false);
+    if(optReport.get<double>("sos")>1.1
+       || optReport.get<double>("eq")>.01
+       || optReport.get<double>("ineq")>.01){
       cout <<optReport <<endl <<"something's wrong?" <<endl;
       //UNDO OPTIMIZATION:
 //      komo.setConfiguration_qOrg(0, komo.getConfiguration_qOrg(-1));
       rai::wait();
 //      animate=2;
+    }
   }
 //  komo.checkGradients();
 //  komo.pathConfig.watch(false, "komo");
@@ -24,6 +24,13 @@ struct CtrlSolver : NonCopyable {
 
   rai::Array<shared_ptr<CtrlObjective>> objectives;    ///< list of objectives
 
+  //-- repeated solving
+  bool warmStart;     ///< keep the komo problem and solver workspace across solve() calls while the active objectives do not change
+  bool realtime;      ///< bounded solver iterations and no blocking on failures; the report is only computed on report()
+  rai::OptOptions opt;
+  double sos=0., eq=0., ineq=0.;  ///< errors of the last solve
+  rai::Array<shared_ptr<CtrlObjective>> komoObjectives; ///< the active objectives the komo problem was built for
+
   CtrlSolver(const rai::Configuration& _C, double _tau, uint k_order=1);
   ~CtrlSolver();
 
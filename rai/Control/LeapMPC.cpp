@@ -2,6 +2,14 @@
 
 LeapMPC::LeapMPC(rai::Configuration& C, double timingScale){
   komo.setModel(C, false);
+  komo.opt.reuseSolver = rai::getParameter<bool>("LeapMPC/warmStart", true);
+  komo.opt.verbose=0;
+  opt.stopTolerance = 1e-4;
+  opt.stopGTolerance = 1e-4;
+  if(rai::getParameter<bool>("LeapMPC/realtime", false)){
+    opt.stopIters = rai::getParameter<int>("LeapMPC/maxIters", 10);
+    opt.stopOuters = rai::getParameter<int>("LeapMPC/maxOuters", 2);
+  }
 #if 0
   komo.setTiming(2., 1, .1, 2);
 
@@ -50,11 +58,7 @@ void LeapMPC::reinit(const rai::Configuration& C){
 }
 
 void LeapMPC::solve(){
-  //re-run KOMO
-  rai::OptOptions opt;
-  opt.stopTolerance = 1e-4;
-  opt.stopGTolerance = 1e-4;
-  komo.opt.verbose=0;
+  //re-run KOMO (in its persistent workspace, if komo.opt.reuseSolver)
   komo.optimize(0., opt);
   //komo.checkGradients();
 
@@ -58,12 +58,75 @@ const bool lapackSupported=true;
 #else
 const bool lapackSupported=false;
 #endif
-int64_t globalMemoryTotal=0, globalMemoryBound=1ull<<32; //this is 1GB
+std::atomic<int64_t> globalMemoryTotal(0);
+std::atomic<uint64_t> globalMemoryAllocs(0);
+int64_t globalMemoryBound=1ull<<32; //this is 1GB
 bool globalMemoryStrict=false;
 const char* arrayElemsep=", ";
 const char* arrayLinesep=",\n ";
 const char* arrayBrackets="[]";
 
+void countArrayMemory(int64_t bytes) {
+  int64_t total = (globalMemoryTotal += bytes);
+  if(bytes>0 && total>globalMemoryBound) {
+    if(globalMemoryStrict) {
+      globalMemoryTotal -= bytes;
+      HALT("out of memory: " <<(total>>20) <<"MB");
+    }
+    LOG(0) <<"using massive memory: " <<(total>>20) <<"MB";
+  }
+}
+
+//===========================================================================
+//
+// ArrayArena
+//
+
+static const uint arenaHeader=16; //keeps blocks 16-byte aligned; stores the size class
+
+ArrayArena::~ArrayArena() {
+  CHECK(current()!=this, "destroying an ArrayArena that is still in scope");
+  for(std::vector<void*>& blocks:freeBlocks) for(void* b:blocks) free((char*)b-arenaHeader);
+}
+
+ArrayArena::Scope::Scope(ArrayArena* A) : prev(current()) { if(A) current()=A; }
+
+ArrayArena::Scope::~Scope() { current()=prev; }
+
+ArrayArena*& ArrayArena::current() {
+  static thread_local ArrayArena* arena=nullptr;
+  return arena;
+}
+
+void* ArrayArena::alloc(uint64_t& bytes) {
+  ArrayArena* A=current();
+  if(!A) return nullptr;
+  uint c=0;
+  while(c<numClasses && (64ull<<c)<bytes) c++;
+  if(c==numClasses) return nullptr;
+  bytes = 64ull<<c;
+  std::vector<void*>& blocks = A->freeBlocks[c];
+  if(blocks.size()) {
+    A->hits++;
+    void* b=blocks.back();
+    blocks.pop_back();
+    return b;
+  }
+  A->misses++;
+  globalMemoryAllocs++;
+  char* b = (char*)malloc(bytes+arenaHeader);
+  if(!b) HALT("memory allocation failed! Wanted size = " <<bytes <<"bytes");
+  *(uint*)b = c;
+  return b+arenaHeader;
+}
+
+void ArrayArena::release(void* block) {
+  char* b = (char*)block-arenaHeader;
+  ArrayArena* A=current();
+  if(A) A->freeBlocks[*(uint*)b].push_back(block);
+  else free(b);
+}
+
 //===========================================================================
 }
 
@@ -1982,11 +2045,45 @@ arr eigen_Ainv_b(const arr& A, const arr& b) {
   return NoArr;
 }
 
+struct rai::SparseCholesky_self {
+  Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> solver;
+};
+
+rai::SparseCholesky::SparseCholesky() : self(make_unique<SparseCholesky_self>()) {}
+
+rai::SparseCholesky::~SparseCholesky() {}
+
+bool rai::SparseCholesky::factor(const arr& A) {
+  CHECK(isSparseMatrix(A), "");
+  CHECK_EQ(A.d0, A.d1, "");
+  const rai::SparseMatrix& As = A.sparse();
+  Eigen::SparseMatrix<double> Aeig = conv_sparseArr2sparseEigen(As);
+  if(As.elems!=pattern) {
+    self->solver.analyzePattern(Aeig);
+    pattern = As.elems;
+    analyses++;
+  }
+  self->solver.factorize(Aeig);
+  factorizations++;
+  return self->solver.info()==Eigen::Success;
+}
+
+arr rai::SparseCholesky::solve(const arr& b) {
+  CHECK(self->solver.info()==Eigen::Success, "no successful factorization");
+  Eigen::MatrixXd x = self->solver.solve(conv_arr2eigen(b));
+  return conv_eigen2arr(x);
+}
+
 #else //RAI_EIGEN
 
 //Eigen::SparseMatrix<double> conv_sparseArr2sparseEigen(const rai::SparseMatrix& S){ NICO }
 //arr conv_sparseEigen2sparseArr(Eigen::SparseMatrix<double>& E){ NICO }
 arr eigen_Ainv_b(const arr& A, const arr& b) { NICO }
+struct rai::SparseCholesky_self {};
+rai::SparseCholesky::SparseCholesky() {}
+rai::SparseCholesky::~SparseCholesky() {}
+bool rai::SparseCholesky::factor(const arr& A) { NICO }
+arr rai::SparseCholesky::solve(const arr& b) { NICO }
 
 #endif //RAI_EIGEN
 
@@ -2309,6 +2406,48 @@ void rai::RowShifted::rowWiseMult(const arr& a) {
   }
 }
 
+bool rai::RowShifted::cholesky() {
+  CHECK(symmetric, "this is not a symmetric matrix");
+  uint n=Z.d0, w=rowSize;
+  for(uint i=0; i<n; i++) CHECK_EQ(rowShift.p[i], i, "this is not shifted as an upper triangle");
+  //U(l,j) is stored at entry(l, j-l), non-zero only for l<=j<l+w
+  for(uint i=0; i<n; i++) {
+    double* Ui = Z.p+i*w;
+    for(uint k=0; k<w && i+k<n; k++) {
+      uint j=i+k;
+      double s=Ui[k];
+      for(uint l=(j+1>w?j+1-w:0); l<i; l++) s -= Z.p[l*w+i-l] * Z.p[l*w+j-l];
+      if(!k) {
+        if(!(s>0.)) return false;
+        Ui[0] = ::sqrt(s);
+      } else {
+        Ui[k] = s/Ui[0];
+      }
+    }
+  }
+  return true;
+}
+
+arr rai::RowShifted::cholesky_solve(const arr& b) const {
+  uint n=Z.d0, w=rowSize;
+  CHECK_EQ(b.N, n, "");
+  arr x = b;
+  //forward: U^T y = b
+  for(uint i=0; i<n; i++) {
+    double s=x.p[i];
+    for(uint l=(i+1>w?i+1-w:0); l<i; l++) s -= Z.p[l*w+i-l] * x.p[l];
+    x.p[i] = s/Z.p[i*w];
+  }
+  //backward: U x = y
+  for(uint i=n; i--;) {
+    const double* Ui = Z.p+i*w;
+    double s=x.p[i];
+    for(uint k=1; k<w && i+k<n; k++) s -= Ui[k] * x.p[i+k];
+    x.p[i] = s/Ui[0];
+  }
+  return x;
+}
+
 void rai::RowShifted::add(const arr& B, uint lo0, uint lo1, double coeff){
   if(isRowShifted(B)){
     const RowShifted& Br = B.rowShifted();
@@ -14,6 +14,8 @@
 #include <functional>
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <cmath>
 
 #define ARR ARRAY<double> ///< write ARR(1., 4., 5., 7.) to generate a double-Array
 #define TUP ARRAY<uint> ///< write TUP(1, 2, 3) to generate a uint-Array
@@ -40,8 +42,40 @@ struct RowShifted;
 // OLD, TODO: hide -> array.cpp
 extern bool useLapack;
 extern const bool lapackSupported;
-extern int64_t globalMemoryTotal, globalMemoryBound;
+extern std::atomic<int64_t> globalMemoryTotal;  ///< heap memory currently held by arrays (thread-safe)
+extern std::atomic<uint64_t> globalMemoryAllocs; ///< number of malloc/realloc/new[] calls made by arrays (thread-safe)
+extern int64_t globalMemoryBound;
 extern bool globalMemoryStrict;
+void countArrayMemory(int64_t bytes); ///< account for (de)allocated array memory; checks globalMemoryBound
+
+/** A pool for array memory: while an ArrayArena is in Scope, arrays of
+    elementary types allocated or resized by this thread take their
+    buffers from it and return them to it on release, so repeated
+    evaluations (e.g. of a KOMO problem) reuse the same blocks instead of
+    calling malloc/free. Scopes nest (the innermost is used); an arena
+    must be in scope on only one thread at a time. Blocks may safely
+    outlive their arena: they are then freed normally. */
+struct ArrayArena {
+  static constexpr uint numClasses=16;    ///< power-of-two block sizes from 64 bytes to 2MB
+  std::vector<void*> freeBlocks[numClasses];
+  uint64_t hits=0, misses=0;              ///< how often a block was reused from the pool / had to be malloc'ed
+
+  ArrayArena() {}
+  ~ArrayArena();
+  ArrayArena(const ArrayArena&) = delete;
+  ArrayArena& operator=(const ArrayArena&) = delete;
+
+  /// makes A (if not nullptr) the current arena of this thread for the lifetime of the scope
+  struct Scope {
+    ArrayArena* prev;
+    Scope(ArrayArena* A);
+    ~Scope();
+  };
+
+  static ArrayArena*& current();          ///< the arena of the innermost scope of this thread (or nullptr)
+  static void* alloc(uint64_t& bytes);    ///< a block of at least 'bytes' (rounded up); nullptr if there is no current arena or the block is too large
+  static void release(void* block);       ///< return a block (to the current arena if any, to the heap otherwise)
+};
 
 // default write formatting
 extern const char* arrayElemsep;
@@ -67,6 +101,7 @@ template<class T> struct ArrayIterationEnumerated;
 template<class T> struct ArrayIterationReverse;
 template<class T> struct ArrayModRaw;
 template<class T> struct ArrayModList;
+template<class T, class E> struct ArrayExpr;
 
 /** Simple array container to store arbitrary-dimensional arrays (tensors).
   Can buffer more memory than necessary for faster
@@ -83,6 +118,7 @@ template<class T> struct Array : /*std::vector<T>,*/ Serializable {
   uint d0, d1, d2; ///< 0th, 1st, 2nd dim
   uint* d;  ///< pointer to dimensions (for nd<=3 points to d0)
   bool isReference; ///< true if this refers to memory of another array
+  char memKind;     ///< where p lives: 0=heap, 1=the inline buffer smallBuf, 2=a pool block (see ArrayArena)
   uint M;   ///< memory allocated (>=N)
 
   static int  sizeT;   ///< constant for each type T: stores the sizeof(T)
@@ -92,6 +128,14 @@ template<class T> struct Array : /*std::vector<T>,*/ Serializable {
   SpecialArray* special; ///< auxiliary data, e.g. if this is a sparse matrics, depends on special type
   std::unique_ptr<Array<T>> jac=0; ///< optional pointer to Jacobian, to enable autodiff
 
+  /// short arrays of elementary types (3-vectors, quaternions, ...) are stored inline, without heap allocation. Caveats:
+  /// (1) the buffer is a member for every T (also those that never use it), so sizeof(Array<T>) grows by smallBytes
+  ///     plus alignment padding -- relevant for arrays of arrays and structs holding many arrays;
+  /// (2) moving (or stealMEM of) an inline array copies its elements into the target: unlike for heap arrays,
+  ///     pointers and references into the moved-from array (p, &a(i), reference sub-arrays) do not follow the data
+  static constexpr uint smallBytes=32;
+  alignas(16) char smallBuf[smallBytes];
+
   typedef std::function<bool(const T& a, const T& b)> ElemCompare;
 
   /// @name constructors
@@ -113,6 +157,7 @@ template<class T> struct Array : /*std::vector<T>,*/ Serializable {
   Array<T>& operator=(const T& v);
   Array<T>& operator=(const Array<T>& a);
   Array<T>& operator=(const std::vector<T>& values);
+  template<class E> Array<T>& operator=(const ArrayExpr<T, E>& e); ///< evaluate a lazy element-wise expression in one pass (see lazy())
 
   /// @name iterators
   typename std::vector<T>::iterator begin() { return typename std::vector<T>::iterator(p); }
@@ -329,6 +374,8 @@ template<class T> struct Array : /*std::vector<T>,*/ Serializable {
   void reserveMEM(uint Mforce) { resizeMEM(N, true, Mforce); if(!nd) nd=1; }
   void freeMEM();
   void resetD();
+  void stealMEM(Array<T>& a); ///< take over the buffer (p, M) of a, leaving a without memory; inline buffers are copied
+  void releaseMEM();          ///< release the buffer p (heap, pool or inline) without touching dims
 
   /// @name serialization
   uint serial_size();
@@ -444,7 +491,131 @@ BinaryOperator(-, -=);
 //BinaryOperator(/ , /=);
 #undef BinaryOperator
 
+//element-wise operators on temporaries: update the temporary in place instead of allocating another one
+template<class T> Array<T> operator+(Array<T>&& y, const Array<T>& z);
+template<class T> Array<T> operator+(const Array<T>& y, Array<T>&& z);
+template<class T> Array<T> operator+(Array<T>&& y, Array<T>&& z);
+template<class T> Array<T> operator+(Array<T>&& y, T z);
+template<class T> Array<T> operator+(T y, Array<T>&& z);
+template<class T> Array<T> operator-(Array<T>&& y, const Array<T>& z);
+template<class T> Array<T> operator-(Array<T>&& y, Array<T>&& z);
+template<class T> Array<T> operator-(Array<T>&& y, T z);
+template<class T> Array<T> operator-(Array<T>&& y);
+template<class T> Array<T> operator*(Array<T>&& y, T z);
+template<class T> Array<T> operator*(T y, Array<T>&& z);
+template<class T> Array<T> operator/(Array<T>&& y, T z);
+
 /// @} //name
+
+//===========================================================================
+/// @name lazy element-wise expressions
+/** lazy(x) wraps an array; +, -, % (element-wise product), / and scalar
+    factors combine wrapped arrays into an expression tree that is only
+    evaluated when assigned (x = ..., x += ..., x -= ...) or reduced (sum,
+    sumOfSqr, scalarProduct, absMax) -- in a single pass over the data and
+    without temporaries, e.g. x = lazy(a) + (s/d)*lazy(b);
+    Operands must be non-empty plain dense arrays without Jacobians (no
+    autodiff); scalar factors are explicit leaves that broadcast. */
+/// @{
+
+template<class T, class E> struct ArrayExpr {
+  const E& self() const { return static_cast<const E&>(*this); }
+};
+
+template<class T> struct ArrayExprLeaf : ArrayExpr<T, ArrayExprLeaf<T>> {
+  static constexpr bool isScalar = false;
+  const Array<T>& a;
+  const T* p;
+  ArrayExprLeaf(const Array<T>& _a);
+  T operator[](uint i) const { return p[i]; }
+  uint size() const { return a.N; }
+  const Array<T>* shape() const { return &a; }
+};
+
+template<class T> struct ArrayExprScalar : ArrayExpr<T, ArrayExprScalar<T>> {
+  typedef T type;
+  static constexpr bool isScalar = true;
+  T s;
+  ArrayExprScalar(T _s) : s(_s) {}
+  T operator[](uint) const { return s; }
+  uint size() const { return 0; } //never used for sizing: broadcasts to the other operand
+  const Array<T>* shape() const { return nullptr; }
+};
+
+template<class T, class A, class B, class Op> struct ArrayExprBinary : ArrayExpr<T, ArrayExprBinary<T, A, B, Op>> {
+  static constexpr bool isScalar = A::isScalar && B::isScalar;
+  A a; //nodes are stored by value (they are small, leaves only refer to their arrays)
+  B b;
+  ArrayExprBinary(const A& _a, const B& _b);
+  T operator[](uint i) const { return Op::apply(a[i], b[i]); }
+  uint size() const { return A::isScalar? b.size() : a.size(); }
+  const Array<T>* shape() const { return A::isScalar? b.shape() : a.shape(); }
+};
+
+template<class T, class A, class F> struct ArrayExprUnary : ArrayExpr<T, ArrayExprUnary<T, A, F>> {
+  static constexpr bool isScalar = A::isScalar;
+  A a;
+  ArrayExprUnary(const A& _a) : a(_a) {}
+  T operator[](uint i) const { return F::apply(a[i]); }
+  uint size() const { return a.size(); }
+  const Array<T>* shape() const { return a.shape(); }
+};
+
+template<class T> ArrayExprLeaf<T> lazy(const Array<T>& x) { return ArrayExprLeaf<T>(x); }
+
+/// sum_i f(i) with four independent accumulators, so that the compiler can vectorize the reduction
+template<class T, class F> T reduceSum(uint n, const F& f) {
+  T s0(0), s1(0), s2(0), s3(0);
+  uint i=0;
+  for(; i+4<=n; i+=4) { s0+=f(i); s1+=f(i+1); s2+=f(i+2); s3+=f(i+3); }
+  for(; i<n; i++) s0+=f(i);
+  return (s0+s1)+(s2+s3);
+}
+
+/// max(m, f), but a NaN in either argument sticks (plain f>m comparisons would silently drop it)
+template<class T> T maxNaN(T m, T f) { return (f>m || f!=f)? f : m; }
+
+/// max_i f(i), same scheme (f must be non-negative, e.g. an absolute value); NaN if any f(i) is NaN
+template<class T, class F> T reduceMax(uint n, const F& f) {
+  T m0(0), m1(0), m2(0), m3(0);
+  uint i=0;
+  for(; i+4<=n; i+=4) {
+    m0=maxNaN(m0, f(i));
+    m1=maxNaN(m1, f(i+1));
+    m2=maxNaN(m2, f(i+2));
+    m3=maxNaN(m3, f(i+3));
+  }
+  for(; i<n; i++) m0=maxNaN(m0, f(i));
+  return maxNaN(maxNaN(m0, m1), maxNaN(m2, m3));
+}
+
+#define ArrayExprOp( name, expr ) \
+  struct ArrayExprOp_##name { template<class T> static T apply(T a, T b) { return expr; } };
+ArrayExprOp(plus, a+b)
+ArrayExprOp(minus, a-b)
+ArrayExprOp(times, a*b)
+ArrayExprOp(divide, a/b)
+#undef ArrayExprOp
+
+#define ArrayExprOperator( op, name ) \
+  template<class T, class A, class B> ArrayExprBinary<T, A, B, ArrayExprOp_##name> operator op(const ArrayExpr<T, A>& a, const ArrayExpr<T, B>& b) { return {a.self(), b.self()}; } \
+  template<class T, class A> ArrayExprBinary<T, A, ArrayExprScalar<T>, ArrayExprOp_##name> operator op(const ArrayExpr<T, A>& a, typename ArrayExprScalar<T>::type b) { return {a.self(), b}; } \
+  template<class T, class B> ArrayExprBinary<T, ArrayExprScalar<T>, B, ArrayExprOp_##name> operator op(typename ArrayExprScalar<T>::type a, const ArrayExpr<T, B>& b) { return {a, b.self()}; }
+ArrayExprOperator(+, plus)
+ArrayExprOperator(-, minus)
+ArrayExprOperator(%, times)
+ArrayExprOperator(/, divide)
+#undef ArrayExprOperator
+
+//scalar multiplication (* between two expressions is left undefined: for arrays it is the inner product, use % for element-wise)
+template<class T, class A> ArrayExprBinary<T, A, ArrayExprScalar<T>, ArrayExprOp_times> operator*(const ArrayExpr<T, A>& a, typename ArrayExprScalar<T>::type b) { return {a.self(), b}; }
+template<class T, class B> ArrayExprBinary<T, ArrayExprScalar<T>, B, ArrayExprOp_times> operator*(typename ArrayExprScalar<T>::type a, const ArrayExpr<T, B>& b) { return {a, b.self()}; }
+template<class T, class A> ArrayExprBinary<T, ArrayExprScalar<T>, A, ArrayExprOp_minus> operator-(const ArrayExpr<T, A>& a) { return {T(0), a.self()}; }
+
+template<class T, class E> Array<T>& operator+=(Array<T>& x, const ArrayExpr<T, E>& e);
+template<class T, class E> Array<T>& operator-=(Array<T>& x, const ArrayExpr<T, E>& e);
+
+/// @}
 } //namespace
 
 //===========================================================================
@@ -477,6 +648,19 @@ UnaryFunction(sigm);
 UnaryFunction(sign);
 #undef UnaryFunction
 
+//the same on lazy expressions (see rai::lazy)
+#define UnaryFunction( func )           \
+  struct ArrayExprFunc_##func { template<class T> static T apply(T x) { return (T)::func(x); } }; \
+  template<class T, class A> rai::ArrayExprUnary<T, A, ArrayExprFunc_##func> func (const rai::ArrayExpr<T, A>& y) { return {y.self()}; }
+UnaryFunction(cos)
+UnaryFunction(sin)
+UnaryFunction(tanh)
+UnaryFunction(exp)
+UnaryFunction(log)
+UnaryFunction(sqrt)
+UnaryFunction(fabs)
+#undef UnaryFunction
+
 #define BinaryFunction( func )            \
   template<class T> rai::Array<T> func(const rai::Array<T>& y, const rai::Array<T>& z); \
   template<class T> rai::Array<T> func(const rai::Array<T>& y, T z); \
@@ -778,6 +962,10 @@ template<class T> rai::Array<T> mean(const rai::Array<T>& v);
 template<class T> rai::Array<T> stdDev(const rai::Array<T>& v);
 template<class T> T minDiag(const rai::Array<T>& v);
 template<class T> T absMax(const rai::Array<T>& x);
+template<class T, class E> T sum(const rai::ArrayExpr<T, E>& e);
+template<class T, class E> T sumOfSqr(const rai::ArrayExpr<T, E>& e);
+template<class T, class E> T absMax(const rai::ArrayExpr<T, E>& e);
+template<class T, class A, class B> T scalarProduct(const rai::ArrayExpr<T, A>& a, const rai::ArrayExpr<T, B>& b);
 template<class T> T absMin(const rai::Array<T>& x);
 template<class T> void clip(const rai::Array<T>& x, T lo, T hi);
 
@@ -986,6 +1174,10 @@ struct RowShifted : SpecialArray {
   arr B_A(const arr& B) const;
   void rowWiseMult(const arr& a);
 
+  //banded solve (requires symmetric and rowShift(i)==i, as returned by At_A)
+  bool cholesky(); ///< in-place factorization A=U^T U (U overwrites the upper band) in O(n rowSize^2); returns false if not pos-def
+  arr cholesky_solve(const arr& b) const; ///< solves A x = b, after cholesky()
+
   void add(const arr& B, uint lo0=0, uint lo1=0, double coeff=1.);
 
   void write(std::ostream& os) const;
@@ -1046,6 +1238,19 @@ struct SparseMatrix : SpecialArray {
   void checkConsistency() const;
 };
 
+/// sparse Cholesky factorization of a symmetric matrix (via Eigen) -- the symbolic analysis (fill-reducing ordering, elimination tree)
+/// is kept and only redone when the sparsity pattern of A changes; each factor() is only a numeric refactorization
+struct SparseCholesky {
+  intA pattern;         ///< the elems of the last analyzed matrix
+  uint analyses=0, factorizations=0;
+  SparseCholesky();
+  ~SparseCholesky();
+  bool factor(const arr& A); ///< returns false if A is not positive definite (factorization failed)
+  arr solve(const arr& b);
+private:
+  std::unique_ptr<struct SparseCholesky_self> self;
+};
+
 arr unpack(const arr& X);
 arr comp_At_A(const arr& A);
 arr comp_A_At(const arr& A);
@@ -61,6 +61,7 @@ template<class T> rai::Array<T>::Array()
     d0(0), d1(0), d2(0),
     d(&d0),
     isReference(false),
+    memKind(0),
     M(0),
     special(0) {
   if(sizeT==-1) sizeT=sizeof(T);
@@ -76,7 +77,8 @@ template<class T> rai::Array<T>::Array()
         typeid(T)==typeid(long) ||
         typeid(T)==typeid(unsigned long) ||
         typeid(T)==typeid(float) ||
-        typeid(T)==typeid(double)) memMove=1;
+        typeid(T)==typeid(double) ||
+        std::is_pointer<T>::value) memMove=1;
   }
 }
 
@@ -86,17 +88,18 @@ template<class T> rai::Array<T>::Array(const rai::Array<T>& a) : Array() { opera
 /// copy constructor
 template<class T> rai::Array<T>::Array(rai::Array<T>&& a)
   : /*std::vector<T>(std::move(a)),*/
-    p(a.p),
+    p(0),
     N(a.N),
     nd(a.nd),
     d0(a.d0), d1(a.d1), d2(a.d2),
     d(&d0),
     isReference(a.isReference),
-    M(a.M),
+    memKind(0),
+    M(0),
     special(a.special){
   if(a.jac) jac = std::move(a.jac);
   CHECK_EQ(a.d, &a.d0, "");
-  a.p=NULL;
+  stealMEM(a);
   a.N=a.nd=a.d0=a.d1=a.d2=0;
   a.isReference=false;
   a.special=NULL;
@@ -458,45 +461,52 @@ template<class T> void rai::Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
 //  vec_type::resize(Mnew);
   p = vec_type::data();
 #else
+  bool useSmall = memMove==1 && Mforce<0 && n*sizeT<=smallBytes && (!Mold || memKind==1);
+  if(useSmall) Mnew=smallBytes/sizeT; //short arrays live in the inline buffer
   CHECK_GE(Mnew, n, "");
   CHECK((p && M) || (!p && !M), "");
   if(Mnew!=Mold) {  //if M changed, allocate the memory
-    globalMemoryTotal -= Mold*sizeT;
-    globalMemoryTotal += Mnew*sizeT;
-    if(globalMemoryTotal>globalMemoryBound){
-      if(globalMemoryStrict){
-        globalMemoryTotal -= Mnew*sizeT;
-        HALT("out of memory: " <<((globalMemoryTotal+Mnew)>>20) <<"MB");
+    if(!Mnew) {
+      releaseMEM();
+    } else if(memMove==1) {
+      uint64_t bytes = uint64_t(Mnew)*sizeT;
+      T* pnew=0;
+      char kindNew=0;
+      if(useSmall) {
+        pnew=(T*)smallBuf;
+        kindNew=1;
+      } else if((pnew=(T*)ArrayArena::alloc(bytes))) {
+        countArrayMemory(bytes);
+        Mnew=bytes/sizeT;
+        kindNew=2;
+      } else if(p && memKind==0) { //plain heap -> heap: realloc (may grow in place)
+        countArrayMemory(int64_t(bytes)-int64_t(uint64_t(Mold)*sizeT));
+        p=(T*)realloc(p, bytes);
+        globalMemoryAllocs++;
+        if(!p) { HALT("memory allocation failed! Wanted size = " <<bytes <<"bytes"); }
+        M=Mnew;
+      } else {
+        countArrayMemory(bytes);
+        pnew=(T*)malloc(bytes);
+        globalMemoryAllocs++;
+        if(!pnew) { HALT("memory allocation failed! Wanted size = " <<bytes <<"bytes"); }
       }
-      LOG(0) <<"using massive memory: " <<(globalMemoryTotal>>20) <<"MB";
-    }
-    if(Mnew) {
-      if(memMove==1){
-        if(p){
-          p=(T*)realloc(p, Mnew*sizeT);
-        } else {
-          p=(T*)malloc(Mnew*sizeT);
-          //memset(p, 0, Mnew*sizeT);
-        }
-        if(!p) { HALT("memory allocation failed! Wanted size = " <<Mnew*sizeT <<"bytes"); }
-      }else{
-        T* pold = p;
-        p=new T [Mnew];
-        if(!p) { HALT("memory allocation failed! Wanted size = " <<Mnew*sizeT <<"bytes"); }
-        if(copy) for(uint i=N<n?N:n; i--;) p[i]=pold[i];
-        if(pold) delete[] pold;
+      if(pnew) {
+        if(p) memmove(pnew, p, sizeT*(N<n?N:n));
+        releaseMEM();
+        p=pnew;
+        M=Mnew;
+        memKind=kindNew;
       }
-      M=Mnew;
     } else {
-      if(p) {
-        if(memMove==1){
-          free(p);
-        }else{
-          delete[] p;
-        }
-        p=0;
-        M=0;
-      }
+      countArrayMemory(int64_t(uint64_t(Mnew)*sizeT)-int64_t(uint64_t(Mold)*sizeT));
+      T* pold = p;
+      p=new T [Mnew];
+      globalMemoryAllocs++;
+      if(!p) { HALT("memory allocation failed! Wanted size = " <<Mnew*sizeT <<"bytes"); }
+      if(copy) for(uint i=N<n?N:n; i--;) p[i]=pold[i];
+      if(pold) delete[] pold;
+      M=Mnew;
     }
   }
 #endif
@@ -509,16 +519,7 @@ template<class T> void rai::Array<T>::freeMEM() {
 #ifdef RAI_USE_STDVEC
   vec_type::clear();
 #else
-  if(M) {
-    rai::globalMemoryTotal -= M*sizeT;
-    if(memMove==1){
-      free(p);
-    }else{
-      delete[] p;
-    }
-    p=0;
-    M=0;
-  }
+  releaseMEM();
 #endif
   if(d && d!=&d0) { delete[] d; d=NULL; }
   p=NULL;
@@ -526,6 +527,38 @@ template<class T> void rai::Array<T>::freeMEM() {
   d=&d0;
   isReference=false;
 }
+
+/// release the buffer p according to where it lives (heap, arena pool or inline) -- references own nothing (M==0)
+template<class T> void rai::Array<T>::releaseMEM() {
+  if(!M) return;
+  if(memKind==1) {
+    //inline buffer: nothing to free, not counted
+  } else {
+    countArrayMemory(-int64_t(uint64_t(M)*sizeT));
+    if(memKind==2) ArrayArena::release(p);
+    else if(memMove==1) free(p);
+    else delete[] p;
+  }
+  p=0;
+  M=0;
+  memKind=0;
+}
+
+/// take over the buffer of a (which is left without memory); an inline buffer can't be taken over and is copied
+template<class T> void rai::Array<T>::stealMEM(Array<T>& a) {
+  releaseMEM();
+  if(a.memKind==1) {
+    memmove(smallBuf, a.smallBuf, smallBytes);
+    p=(T*)smallBuf;
+  } else {
+    p=a.p;
+  }
+  M=a.M;
+  memKind=a.memKind;
+  a.p=0;
+  a.M=0;
+  a.memKind=0;
+}
 #endif
 
 ///this was a reference; becomes a copy
@@ -1763,9 +1796,9 @@ template<class T> void rai::Array<T>::takeOver(rai::Array<T>& a) {
   freeMEM();
   memMove=a.memMove;
   N=a.N; nd=a.nd; d0=a.d0; d1=a.d1; d2=a.d2;
-  p=a.p; M=a.M;
+  stealMEM(a);
+  a.p=p;
   a.isReference=true;
-  a.M=0;
 }
 
 template<class T> void rai::Array<T>::swap(Array<T>& a) {
@@ -1776,19 +1809,16 @@ template<class T> void rai::Array<T>::swap(Array<T>& a) {
   std::swap((vec_type&)*this, (vec_type&)a);
 #endif
 
-#define SWAPx(X, Y){ auto z=X; X=Y; Y=z; }
-  SWAPx(p, a.p);
-//  SWAPx(special, a.special);
-//  SWAPx(isReference, a.isReference);
-//  T* p_tmp = p;
-//  p=a.p;
-//  a.p=p_tmp;
-#undef SWAPx
+  {
+    Array<T> tmp;
+    tmp.stealMEM(*this);
+    stealMEM(a);
+    a.stealMEM(tmp);
+  }
 
   uint z;
 #define SWAP(X, Y){ z=X; X=Y; Y=z; }
   SWAP(N, a.N);
-  SWAP(M, a.M);
   SWAP(nd, a.nd);
   SWAP(d0, a.d0);
   SWAP(d1, a.d1);
@@ -2546,22 +2576,20 @@ template<class T>
 T sqrDistance(const rai::Array<T>& v, const rai::Array<T>& w) {
   CHECK_EQ(v.N, w.N,
            "sqrDistance on different array dimensions (" <<v.N <<", " <<w.N <<")");
-  T d, t(0);
-  for(uint i=v.N; i--;) { d=v.p[i]-w.p[i]; t+=d*d; }
-  return t;
+  const T* vp=v.p, *wp=w.p;
+  return rai::reduceSum<T>(v.N, [vp, wp](uint i) { T d=vp[i]-wp[i]; return d*d; });
 }
 
 template<class T> T maxDiff(const rai::Array<T>& v, const rai::Array<T>& w, uint* im) {
   CHECK_EQ(v.N, w.N,
            "maxDiff on different array dimensions (" <<v.N <<", " <<w.N <<")");
   T d(0), t(0);
-  if(!im)
-    for(uint i=v.N; i--;) {
-      d=(T)std::fabs((double)(v.p[i]-w.p[i]));
-      if(d>t) t=d;
-    } else {
+  if(!im) {
+    const T* vp=v.p, *wp=w.p;
+    t = rai::reduceMax<T>(v.N, [vp, wp](uint i) { return (T)std::fabs((double)(vp[i]-wp[i])); });
+  } else {
     *im=0;
-    for(uint i=v.N; i--;) { d=(T)std::fabs((double)(v.p[i]-w.p[i])); if(d>t) { t=d; *im=i; } }
+    for(uint i=v.N; i--;) { d=(T)std::fabs((double)(v.p[i]-w.p[i])); if(d>t || d!=d) { t=d; *im=i; if(d!=d) break; } }
   }
   return t;
 }
@@ -2616,9 +2644,8 @@ T metricDistance(const rai::Array<T>& g, const rai::Array<T>& v, const rai::Arra
 
 /// \f$\sum_i x_i\f$
 template<class T> T sum(const rai::Array<T>& v) {
-  T t(0);
-  for(uint i=v.N; i--; t+=v.p[i]) {};
-  return t;
+  const T* vp=v.p;
+  return rai::reduceSum<T>(v.N, [vp](uint i) { return vp[i]; });
 }
 
 /// \f$\max_i x_i\f$
@@ -2747,9 +2774,8 @@ template<class T> T sumOfPos(const rai::Array<T>& v) {
 
 /// \f$\sum_i x_i^2\f$
 template<class T> T sumOfSqr(const rai::Array<T>& v) {
-  T t(0);
-  for(uint i=v.N; i--; t+=v.p[i]*v.p[i]) {};
-  return t;
+  const T* vp=v.p;
+  return rai::reduceSum<T>(v.N, [vp](uint i) { return vp[i]*vp[i]; });
 }
 
 /// \f$\sqrt{\sum_i x_i^2}\f$
@@ -2803,11 +2829,8 @@ template<class T> T absMin(const rai::Array<T>& x) {
 
 /// get absolute maximum (using fabs)
 template<class T> T absMax(const rai::Array<T>& x) {
-  if(!x.N) return (T)0;
-  uint i;
-  T t((T)std::fabs((double)x.p[0]));
-  for(i=1; i<x.N; i++) if(std::fabs((double)x.p[i])>t) t=(T)std::fabs((double)x.p[i]);
-  return t;
+  const T* xp=x.p;
+  return rai::reduceMax<T>(x.N, [xp](uint i) { return (T)std::fabs((double)xp[i]); });
 }
 
 /// get absolute min (using fabs)
@@ -3152,7 +3175,8 @@ T scalarProduct(const rai::Array<T>& v, const rai::Array<T>& w) {
   if(!v.special && !w.special) {
     CHECK_EQ(v.N, w.N,
              "scalar product on different array dimensions (" <<v.N <<", " <<w.N <<")");
-    for(uint i=v.N; i--; t+=v.p[i]*w.p[i]);
+    const T* vp=v.p, *wp=w.p;
+    t = rai::reduceSum<T>(v.N, [vp, wp](uint i) { return vp[i]*wp[i]; });
   } else {
     if(isSparseVector(v) && isSparseVector(w)) {
       rai::SparseVector* sv = dynamic_cast<rai::SparseVector*>(v.special);
@@ -3900,6 +3924,22 @@ template<class T> Array<T> operator/(const Array<T>& y, T z) {             Array
 /// element-wise division
 template<class T> Array<T> operator/(const Array<T>& y, const Array<T>& z) { Array<T> x(y); x/=z; return x; }
 
+//on temporaries: reuse the temporary's buffer, unless it refers to other memory or is special
+template<class T> bool canReuse(const Array<T>& y) { return !y.isReference && !y.special; }
+
+template<class T> Array<T> operator+(Array<T>&& y, const Array<T>& z) { if(!canReuse(y)) return (const Array<T>&)y + z; y+=z; return std::move(y); }
+template<class T> Array<T> operator+(const Array<T>& y, Array<T>&& z) { if(!canReuse(z) || !samedim(y, z)) return y + (const Array<T>&)z; z+=y; return std::move(z); }
+template<class T> Array<T> operator+(Array<T>&& y, Array<T>&& z) {      if(canReuse(y)) return std::move(y) + (const Array<T>&)z; return (const Array<T>&)y + std::move(z); }
+template<class T> Array<T> operator+(Array<T>&& y, T z) {               if(!canReuse(y)) return (const Array<T>&)y + z; y+=z; return std::move(y); }
+template<class T> Array<T> operator+(T y, Array<T>&& z) {               if(!canReuse(z)) return y + (const Array<T>&)z; z+=y; return std::move(z); }
+template<class T> Array<T> operator-(Array<T>&& y, const Array<T>& z) { if(!canReuse(y)) return (const Array<T>&)y - z; y-=z; return std::move(y); }
+template<class T> Array<T> operator-(Array<T>&& y, Array<T>&& z) {      return std::move(y) - (const Array<T>&)z; }
+template<class T> Array<T> operator-(Array<T>&& y, T z) {               if(!canReuse(y)) return (const Array<T>&)y - z; y-=z; return std::move(y); }
+template<class T> Array<T> operator-(Array<T>&& y) {                    if(!canReuse(y)) return -(const Array<T>&)y; y*=T(-1); return std::move(y); }
+template<class T> Array<T> operator*(Array<T>&& y, T z) {               if(!canReuse(y)) return (const Array<T>&)y * z; y*=z; return std::move(y); }
+template<class T> Array<T> operator*(T y, Array<T>&& z) {               if(!canReuse(z)) return y * (const Array<T>&)z; z*=y; return std::move(z); }
+template<class T> Array<T> operator/(Array<T>&& y, T z) {               if(!canReuse(y)) return (const Array<T>&)y / z; y/=z; return std::move(y); }
+
 /// contatenation of two arrays
 template<class T> Array<T> operator, (const Array<T>& y, const Array<T>& z) { Array<T> x(y); x.append(z); return x; }
 
@@ -4048,6 +4088,78 @@ template<class T> Array<T>& operator/=(Array<T>& x, T y){
 #undef UpdateOperator_MM
 #undef UpdateOperator_MS
 
+//---------- lazy expressions
+
+template<class T> ArrayExprLeaf<T>::ArrayExprLeaf(const Array<T>& _a) : a(_a), p(_a.p) {
+  CHECK(a.N, "lazy expression on an empty array");
+  CHECK(!a.special, "lazy expressions only on plain dense arrays");
+  CHECK(!a.jac, "lazy expressions do not propagate Jacobians -- use the normal operators");
+}
+
+template<class T, class A, class B, class Op> ArrayExprBinary<T, A, B, Op>::ArrayExprBinary(const A& _a, const B& _b) : a(_a), b(_b) {
+  static_assert(!isScalar, "lazy expression without any array");
+  CHECK(A::isScalar || B::isScalar || a.size()==b.size(), "lazy expression on different array sizes (" <<a.size() <<", " <<b.size() <<")");
+}
+
+template<class T, class E> Array<T>& operator+=(Array<T>& x, const ArrayExpr<T, E>& e) {
+  const E& f = e.self();
+  CHECK(!x.special && !x.jac, "");
+  CHECK_EQ(x.N, f.size(), "lazy update on different array dimensions (" <<x.N <<", " <<f.size() <<")");
+  T* xp=x.p;
+  for(uint i=0; i<x.N; i++) xp[i] += f[i];
+  return x;
+}
+
+template<class T, class E> Array<T>& operator-=(Array<T>& x, const ArrayExpr<T, E>& e) {
+  const E& f = e.self();
+  CHECK(!x.special && !x.jac, "");
+  CHECK_EQ(x.N, f.size(), "lazy update on different array dimensions (" <<x.N <<", " <<f.size() <<")");
+  T* xp=x.p;
+  for(uint i=0; i<x.N; i++) xp[i] -= f[i];
+  return x;
+}
+
+} //namespace rai
+
+/// evaluates the expression element by element -- x may itself appear in the expression (e.g. x = lazy(x) + 2.*lazy(y))
+template<class T> template<class E> rai::Array<T>& rai::Array<T>::operator=(const rai::ArrayExpr<T, E>& e) {
+  const E& f = e.self();
+  const Array<T>* s = f.shape();
+  CHECK(s, "lazy expression without any array");
+  if(s!=this) {
+    if(isReference) { CHECK_EQ(N, f.size(), "resizing of a reference"); }
+    else resizeAs(*s);
+  }
+  if(jac) jac.reset();
+  T* xp=p;
+  for(uint i=0; i<N; i++) xp[i] = f[i];
+  return *this;
+}
+
+template<class T, class E> T sum(const rai::ArrayExpr<T, E>& e) {
+  const E& f = e.self();
+  return rai::reduceSum<T>(f.size(), [&f](uint i) { return f[i]; });
+}
+
+template<class T, class E> T sumOfSqr(const rai::ArrayExpr<T, E>& e) {
+  const E& f = e.self();
+  return rai::reduceSum<T>(f.size(), [&f](uint i) { T d=f[i]; return d*d; });
+}
+
+template<class T, class E> T absMax(const rai::ArrayExpr<T, E>& e) {
+  const E& f = e.self();
+  return rai::reduceMax<T>(f.size(), [&f](uint i) { return (T)std::fabs((double)f[i]); });
+}
+
+template<class T, class A, class B> T scalarProduct(const rai::ArrayExpr<T, A>& a, const rai::ArrayExpr<T, B>& b) {
+  const A& f = a.self();
+  const B& g = b.self();
+  CHECK_EQ(f.size(), g.size(), "scalar product on different array dimensions (" <<f.size() <<", " <<g.size() <<")");
+  return rai::reduceSum<T>(f.size(), [&f, &g](uint i) { return f[i]*g[i]; });
+}
+
+namespace rai {
+
 
 /// allows a notation such as x <<"[0 1; 2 3]"; to initialize an array x
 //template<class T> Array<T>& operator<<(Array<T>& x, const char* str) { std::istringstream ss(str); ss >>x; return x; }
@@ -78,6 +78,7 @@ Node::Node(const std::type_info& _type, Graph& _container, const char* _key, con
   CHECK(&container!=&NoGraph, "This is a NGraph (nullptr) -- don't do that anymore!");
   index=container.N;
   container.NodeL::append(this);
+  if(container.keyIndex.built) container.keyIndex.add(key, this);
   if(_parents.N) for(Node* p: _parents) addParent(p);
 }
 
@@ -91,6 +92,7 @@ Node::~Node() {
     container.removeValue(this);
     container.isIndexed=false;//  container.index();
   }
+  if(container.keyIndex.built) container.keyIndex.remove(key);
 }
 
 void Node::addParent(Node* p, bool prepend) {
@@ -284,6 +286,7 @@ bool Graph::operator!() const {
 }
 
 void Graph::clear() {
+  keyIndex.clear();
   if(ri) { delete ri; ri=nullptr; }
   if(pi) { delete pi; pi=nullptr; }
   DEBUG(checkConsistency();)
@@ -339,8 +342,38 @@ void Graph::appendDict(const std::map<std::string, std::string>& dict) {
   }
 }
 
+static const uint keyIndexMinSize=32; //small graphs (e.g., frame attributes) are faster searched linearly
+
+/// nodes with given key in this graph (not recursing, in list order) via the keyIndex; false if the graph is not indexed
+bool Graph::findIndexed(NodeL& ret, const char* key, bool firstOnly) const {
+  if(!key) return false;
+  std::lock_guard<std::recursive_mutex> lock(keyIndex.mutex);
+  if(!keyIndex.built) {
+    if(N<keyIndexMinSize) return false;
+    for(Node* n:*this) keyIndex.add(n->key, n);
+    keyIndex.built=true;
+  }
+  const std::vector<NameIndex::Entry>* E = keyIndex.find(key);
+  if(!E) return true;
+  if(E->size()>1 && !isIndexed) const_cast<Graph*>(this)->index();
+  if(firstOnly) {
+    Node* first=nullptr;
+    for(const NameIndex::Entry& e:*E) { Node* n=(Node*)e.obj; if(!first || n->index<first->index) first=n; }
+    ret.append(first);
+  } else {
+    for(const NameIndex::Entry& e:*E) ret.append((Node*)e.obj);
+    if(ret.N>1) std::sort(ret.p, ret.p+ret.N, [](Node* a, Node* b) { return a->index<b->index; });
+  }
+  return true;
+}
+
 Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->matches(key)) return n;
+  NodeL found;
+  if(findIndexed(found, key, true)) {
+    if(found.N) return found.elem(0);
+  } else {
+    for(Node* n: (*this)) if(n->matches(key)) return n;
+  }
   Node* ret=nullptr;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNode(key, true, false);
   if(ret) return ret;
@@ -365,7 +398,9 @@ Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool re
 
 NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
+  if(!findIndexed(ret, key, false)) {
+    for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
+  }
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodes(key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodes(key, false, true));
   return ret;
@@ -93,6 +93,7 @@ struct Graph : NodeL {
   bool isDoubleLinked=true;
 
   GraphEditCallbackL callbacks; ///< list of callbacks that are informed about creation and destruction of nodes
+  mutable NameIndex keyIndex; ///< key -> nodes, for findNode(s) in large graphs (built on the first query)
 
   ArrayG<ParseInfo>* pi;     ///< optional annotation of nodes: when detailed file parsing is enabled
   ArrayG<RenderingInfo>* ri; ///< optional annotation of nodes: dot style commands
@@ -132,6 +133,7 @@ struct Graph : NodeL {
   Node* findNodeOfType(const std::type_info& type, const char* key, bool recurseUp=false, bool recurseDown=false) const;
   NodeL findNodesOfType(const std::type_info& type, const char* key, bool recurseUp=false, bool recurseDown=false) const;
   NodeL findGraphNodesWithTag(const char* tag) const;
+  bool findIndexed(NodeL& ret, const char* key, bool firstOnly) const; ///< (internal) lookup via keyIndex
 
   //-- get nodes
   Node* operator[](const char* key) const { return findNode(key); } ///< returns nullptr if not found
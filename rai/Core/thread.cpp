@@ -298,9 +298,16 @@ void Metronome::waitForTic() {
   ticTime += interval;
   std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::duration<double>> now = std::chrono::high_resolution_clock::now();
   if(ticTime>now){
-    std::this_thread::sleep_until(ticTime);
+    if(spinSec>0.) {
+      auto wake = ticTime - std::chrono::duration<double>(spinSec);
+      if(wake>now) std::this_thread::sleep_until(wake);
+      while(std::chrono::high_resolution_clock::now()<ticTime) {} //busy wait the last bit
+    } else {
+      std::this_thread::sleep_until(ticTime);
+    }
   }else{
     ticTime = now;
+    missedTics++;
   }
   tics++;
 }
@@ -310,6 +317,28 @@ double Metronome::getTimeSinceTic() {
   return std::chrono::duration<double>(ticTime-now).count();
 }
 
+bool setRealtimeScheduling(int priority, int cpu) {
+  bool ok=true;
+#if !defined(RAI_MSVC) && !defined(__CYGWIN__) && !defined(__APPLE__)
+  if(priority>0) {
+    sched_param param;
+    param.sched_priority = rai::MIN(priority, sched_get_priority_max(SCHED_FIFO));
+    int r = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if(r) { LOG(-1) <<"could not set SCHED_FIFO priority " <<priority <<" (" <<strerror(r) <<") -- keeping normal scheduling"; ok=false; }
+  }
+  if(cpu>=0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int r = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if(r) { LOG(-1) <<"could not pin thread to cpu " <<cpu <<" (" <<strerror(r) <<")"; ok=false; }
+  }
+#else
+  if(priority>0 || cpu>=0) { LOG(-1) <<"real-time scheduling not supported on this platform"; ok=false; }
+#endif
+  return ok;
+}
+
 //===========================================================================
 //
 // CycleTimer
@@ -333,29 +362,116 @@ CycleTimer::~CycleTimer() {
 
 void CycleTimer::reset() {
   steps=0;
+  overruns=0;
   busyDt=busyDtMean=busyDtMax=1.;
   cyclDt=cyclDtMean=cyclDtMax=1.;
+  lateDt=lateDtMean=lateDtMax=0.;
   lastTime = std::chrono::high_resolution_clock::now();
+  scheduled = lastTime;
 }
 
 void CycleTimer::cycleStart() {
   now = std::chrono::high_resolution_clock::now();
   updateTimeIndicators(cyclDt, cyclDtMean, cyclDtMax, now, lastTime, steps);
   lastTime=now;
+  scheduled=now;
+}
+
+void CycleTimer::cycleStart(const timepoint& _scheduled) {
+  cycleStart();
+  scheduled=_scheduled;
+  updateTimeIndicators(lateDt, lateDtMean, lateDtMax, now, scheduled, steps);
 }
 
 void CycleTimer::cycleDone() {
   now = std::chrono::high_resolution_clock::now();
   updateTimeIndicators(busyDt, busyDtMean, busyDtMax, now, lastTime, steps);
+  if(deadline>0. && (now-scheduled).count()>deadline) overruns++;
   steps++;
 }
 
 rai::String CycleTimer::report() {
   rai::String s;
   s.printf("busy=[%5.1f %5.1f] cycle=[%5.1f %5.1f] load=%4.1f%% steps=%i", busyDtMean, busyDtMax, cyclDtMean, cyclDtMax, 100.*busyDtMean/cyclDtMean, steps);
+  if(deadline>0.) s <<" late[ms]=[" <<1e3*lateDtMean <<' ' <<1e3*lateDtMax <<"] overruns=" <<overruns;
   return s;
 }
 
+//===========================================================================
+//
+// ThreadPool
+//
+
+ThreadPool::ThreadPool(uint numThreads) : next(0) {
+  if(!numThreads) numThreads = std::thread::hardware_concurrency();
+  if(!numThreads) numThreads = 1;
+  for(uint i=1; i<numThreads; i++) workers.emplace_back(&ThreadPool::loop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    quit=true;
+  }
+  cond.notify_all();
+  for(std::thread& th:workers) th.join();
+}
+
+void ThreadPool::parallelFor(uint _n, const std::function<void(uint, uint)>& f) {
+  if(!_n) return;
+  if(!workers.size() || _n==1) { //no need to wake up workers
+    for(uint i=0; i<_n; i++) f(i, 0);
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    job = f;
+    n = _n;
+    next = 0;
+    error = nullptr;
+    running = workers.size();
+    generation++;
+  }
+  cond.notify_all();
+  work(0);
+  std::unique_lock<std::mutex> lock(mutex);
+  condDone.wait(lock, [this]() { return running==0; });
+  job = nullptr;
+  if(error) std::rethrow_exception(error);
+}
+
+void ThreadPool::work(uint threadID) {
+  for(;;) {
+    uint i = next++;
+    if(i>=n) break;
+    try {
+      job(i, threadID);
+    } catch(...) {
+      std::unique_lock<std::mutex> lock(mutex);
+      if(!error) error = std::current_exception();
+      next = n; //skip remaining jobs
+    }
+  }
+}
+
+void ThreadPool::loop(uint threadID) {
+  uint lastGeneration=0;
+  for(;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [this, lastGeneration]() { return quit || generation!=lastGeneration; });
+      if(quit) return;
+      lastGeneration = generation;
+    }
+    work(threadID);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      running--;
+    }
+    condDone.notify_one();
+  }
+}
+
 //=============================================
 //
 // Thread
@@ -382,6 +498,7 @@ Thread::Thread(const char* _name, double beatIntervalSec)
     step_count(0),
     metronome(beatIntervalSec) {
   if(name.N>14) name.resize(14, true);
+  if(beatIntervalSec>0.) timer.deadline=beatIntervalSec;
 }
 
 Thread::~Thread() {
@@ -394,7 +511,15 @@ Thread::~Thread() {
     }
   }
 
+void Thread::setRealtime(int priority, int cpu, double spinSec) {
+  CHECK(!thread, "set real-time options before opening the thread");
+  rtPriority=priority;
+  rtCpu=cpu;
+  metronome.spinSec=spinSec;
+}
+
 void Thread::threadOpen(bool wait, int priority) {
+  if(priority>0) rtPriority=priority;
   {
     auto lock = event.statusMutex(RAI_HERE);
     if(thread) return; //this is already open -- or has just beend opened (parallel call to threadOpen)
@@ -490,9 +615,7 @@ void Thread::threadStop(bool wait) {
 void Thread::main() {
   tid = getpid();
 //  if(verbose>0) cout <<"*** Entering Thread '" <<name <<"'" <<endl;
-  //http://linux.die.net/man/3/setpriority
-  //if(Thread::threadPriority) setRRscheduling(Thread::threadPriority);
-  //if(Thread::threadPriority) setNice(Thread::threadPriority);
+  if(rtPriority>0 || rtCpu>=0) setRealtimeScheduling(rtPriority, rtCpu);
 
   {
     auto mux = stepMutex(RAI_HERE);
@@ -525,7 +648,8 @@ void Thread::main() {
     if(s>0) event.setStatus(1); //step command -> reset to step
 
     //-- make a step
-    timer.cycleStart();
+    if(s==tsBEATING) timer.cycleStart(metronome.ticTime);
+    else timer.cycleStart();
     stepMutex.lock(RAI_HERE);
     step(); //virtual step routine
     stepMutex.unlock();
@@ -16,6 +16,7 @@
 #include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
 
 enum ThreadState { tsIsClosed=-6, tsToOpen=-1, tsLOOPING=-2, tsBEATING=-3, tsIDLE=0, tsToStep=1, tsToClose=-4,  tsFAILURE=-5,  }; //positive states indicate steps-to-go
 struct Signaler;
@@ -223,6 +224,99 @@ struct Var {
 
 template<class T> std::ostream& operator<<(std::ostream& os, Var<T>& x) { x.write(os); return os; }
 
+//===========================================================================
+//
+/** A lock-free single-writer/multi-reader variable, for real-time loops
+    that must never block on (or be blocked by) slow readers. The data is
+    kept in numSlots copies: the writer fills a slot no reader holds and
+    publishes it with an atomic index swap; readers pin the latest
+    published slot and read a consistent snapshot of it. Neither side takes
+    a lock; the writer only spins if more than numSlots-2 readers still
+    hold outdated snapshots. Offers the same get()/set() token API as
+    Var<T>, but no listening/callbacks. The set() token starts from a copy
+    of the latest value (so set()->x=... works as for Var) and publishes
+    on destruction. Only one thread may write at a time. */
+template<class T, uint numSlots=4>
+struct RTVar : NonCopyable {
+  static_assert(numSlots>=3, "RTVar needs at least 3 slots");
+
+  struct alignas(64) Slot {
+    std::atomic<int> pins{0};  ///< -1: being written, 0: free, >0: number of readers
+    int revision=0;
+    double data_time=0.;
+    T data;
+  };
+  Slot slots[numSlots];
+  std::atomic<uint> latest{0};
+  std::atomic<bool> writing{false};
+  rai::String name;
+
+  RTVar(const char* _name=0) : name(_name) {}
+
+  struct RToken {
+    Slot* slot;
+    RToken(RTVar& var, int* getRevision=nullptr) : slot(&var.slots[var.pin()]) { if(getRevision) *getRevision=slot->revision; }
+    RToken(RToken&& t) : slot(t.slot) { t.slot=nullptr; }
+    ~RToken() { if(slot) slot->pins.fetch_sub(1, std::memory_order_release); }
+    const T* operator->() { return &slot->data; }
+    operator const T& () { return slot->data; }
+    const T& operator()() { return slot->data; }
+    int revision() const { return slot->revision; }
+    double dataTime() const { return slot->data_time; }
+  };
+
+  struct WToken {
+    RTVar* var;
+    Slot* slot;
+    WToken(RTVar& _var, double dataTime=-1.) : var(&_var), slot(&_var.claim()) { if(dataTime>=0.) slot->data_time=dataTime; }
+    WToken(WToken&& t) : var(t.var), slot(t.slot) { t.slot=nullptr; }
+    ~WToken() { if(slot) var->publish(*slot); }
+    void operator=(const T& y) { slot->data=y; }
+    T* operator->() { return &slot->data; }
+    operator T& () { return slot->data; }
+    T& operator()() { return slot->data; }
+  };
+
+  RToken get(int* getRevision=nullptr) { return RToken(*this, getRevision); } ///< read a snapshot of the latest value (never blocks)
+  WToken set() { return WToken(*this); }                                       ///< write access; publishes when the token dies
+  WToken set(const double& dataTime) { return WToken(*this, dataTime); }
+  int getRevision() const { return slots[latest.load(std::memory_order_acquire)].revision; } ///< may be stale by the time it returns
+
+private:
+  uint pin() {
+    for(;;) {
+      uint i = latest.load(std::memory_order_acquire);
+      int p = slots[i].pins.load(std::memory_order_relaxed);
+      while(p>=0) if(slots[i].pins.compare_exchange_weak(p, p+1, std::memory_order_acquire)) return i;
+      //the writer has published a newer slot and reclaimed this one -> retry with the newer one
+    }
+  }
+
+  Slot& claim() {
+    bool w=false;
+    CHECK(writing.compare_exchange_strong(w, true, std::memory_order_acquire), "RTVar '" <<name <<"' has a single writer -- it is already being written");
+    uint l = latest.load(std::memory_order_relaxed);
+    for(uint k=1;; k++) {
+      uint j = (l+k)%numSlots;
+      if(j==l) { std::this_thread::yield(); continue; } //all other slots are pinned by (slow) readers
+      int p=0;
+      if(slots[j].pins.compare_exchange_strong(p, -1, std::memory_order_acquire)) {
+        Slot& s = slots[j];
+        s.data = slots[l].data; //only the writer ever modifies slots, so reading the published one is safe
+        s.data_time = slots[l].data_time;
+        s.revision = slots[l].revision+1;
+        return s;
+      }
+    }
+  }
+
+  void publish(Slot& s) {
+    s.pins.store(0, std::memory_order_release);
+    latest.store(&s-slots, std::memory_order_release);
+    writing.store(false, std::memory_order_release);
+  }
+};
+
 //===========================================================================
 
 /// a basic condition variable
@@ -291,6 +385,8 @@ struct Metronome {
   double ticInterval;
   std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::duration<double>> ticTime;
   uint tics;
+  uint missedTics=0;  ///< tics that were already over when waitForTic was called
+  double spinSec=0.;  ///< >0: sleep only until spinSec before the tic and busy-wait the rest (trades CPU for lower wake-up jitter)
 
   Metronome(double ticIntervalSec); ///< set tic tac time in seconds
 
@@ -299,6 +395,9 @@ struct Metronome {
   double getTimeSinceTic();       ///< time since last tic
 };
 
+/// deadline mode for the calling thread: SCHED_FIFO at 'priority' (if >0) and pinning to 'cpu' (if >=0); returns false if not (fully) permitted, keeping normal scheduling
+bool setRealtimeScheduling(int priority, int cpu=-1);
+
 //===========================================================================
 
 /// to meassure cycle and busy times
@@ -307,16 +406,46 @@ struct CycleTimer {
   uint steps;
   double busyDt, busyDtMean, busyDtMax;  ///< internal variables to measure step time
   double cyclDt, cyclDtMean, cyclDtMax;  ///< internal variables to measure step time
-  timepoint now, lastTime;
+  double lateDt, lateDtMean, lateDtMax;  ///< wake-up latency w.r.t. the scheduled start (only with cycleStart(scheduled))
+  double deadline=0.;                    ///< >0: a cycle overruns if it is done later than deadline after its scheduled start
+  uint overruns=0;                       ///< number of cycles that missed the deadline
+  timepoint now, lastTime, scheduled;
   const char* name;                      ///< name
   CycleTimer(const char* _name=nullptr);
   ~CycleTimer();
   void reset();
   void cycleStart();
+  void cycleStart(const timepoint& _scheduled); ///< also measures the latency w.r.t. the time the cycle should have started
   void cycleDone();
   rai::String report();
 };
 
+//===========================================================================
+
+/// a fixed set of worker threads that distributes independent jobs (indices 0..n-1) -- the calling thread participates as worker 0
+struct ThreadPool : NonCopyable {
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable cond, condDone;
+  std::function<void(uint, uint)> job;
+  std::atomic<uint> next;
+  uint n=0, running=0, generation=0;
+  bool quit=false;
+  std::exception_ptr error;
+
+  ThreadPool(uint numThreads=0); ///< numThreads=0 means std::thread::hardware_concurrency()
+  ~ThreadPool();
+
+  uint size() const { return workers.size()+1; }
+
+  /// calls f(i, threadID) exactly once for each i<_n (in arbitrary order and thread); blocks until all are done; rethrows the first exception
+  void parallelFor(uint _n, const std::function<void(uint i, uint threadID)>& f);
+
+private:
+  void work(uint threadID);
+  void loop(uint threadID);
+};
+
 //===========================================================================
 /**
  * A Thread does some calculation and shares the result via a VariableData.
@@ -336,6 +465,8 @@ struct Thread {
   uint step_count;              ///< how often the step was called
   Metronome metronome;          ///< used for beat-looping
   CycleTimer timer;             ///< measure how the time spend per cycle, within step, idle
+  int rtPriority=0;             ///< >0: run with SCHED_FIFO at this priority (if permitted)
+  int rtCpu=-1;                 ///< >=0: pin the thread to this cpu
 
   /// @name c'tor/d'tor
   /** DON'T open drivers/devices/files or so here in the constructor,
@@ -349,7 +480,8 @@ struct Thread {
   virtual ~Thread();
 
   /// @name to be called from `outside' (e.g. the main) to start/step/close the thread
-  void threadOpen(bool wait=false, int priority=0);      ///< start the thread (in idle mode) (should be positive for changes)
+  void threadOpen(bool wait=false, int priority=0);      ///< start the thread (in idle mode); priority>0 requests SCHED_FIFO (see setRealtime)
+  void setRealtime(int priority, int cpu=-1, double spinSec=0.); ///< deadline mode: SCHED_FIFO priority, cpu pinning, spin before tics; call before threadOpen
   void threadClose(double timeoutForce=-1.);                   ///< close the thread (stops looping and waits for idle mode before joining the thread)
   void threadStep();                    ///< trigger (multiple) step (idle -> working mode) (wait until idle? otherwise calling during non-idle -> error)
   void threadLoop(bool waitForOpened=false);  ///< loop, either with fixed beat or at full speed
@@ -385,6 +385,18 @@ double cpuTime() {
   return std::clock() / (double)CLOCKS_PER_SEC;
 }
 
+/** @brief CPU time of the calling thread in floating-point seconds -- unlike
+  cpuTime() not inflated by other threads working concurrently */
+double threadCpuTime() {
+#ifndef RAI_MSVC
+  timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  return t.tv_sec + 1e-9*t.tv_nsec;
+#else
+  return cpuTime();
+#endif
+}
+
 std::string date(const std::chrono::system_clock::time_point& t, bool forFileName) {
   auto in_time_t = std::chrono::system_clock::to_time_t(t);
 
@@ -747,6 +759,7 @@ rai::String& rai::String::setRandom() {
 }
 
 void rai::String::resize(uint n, bool copy) {
+  if(nameIndex) nameIndex->touched(*this);
   if(N==n && M>N) return;
   char* pold=p;
   uint Mold=M;
@@ -767,7 +780,7 @@ void rai::String::resize(uint n, bool copy) {
   resetIstream();
 }
 
-void rai::String::init() { p=0; N=0; M=0; buffer.string=this; flushCallback=nullptr; }
+void rai::String::init() { p=0; N=0; M=0; buffer.string=this; flushCallback=nullptr; nameIndex=nullptr; }
 
 /// standard constructor
 rai::String::String() : std::iostream(&buffer) { init(); clearStream(); }
@@ -848,6 +861,7 @@ rai::String& rai::String::operator=(const std::string& s) {
 
 /// copies from the C-string
 rai::String& rai::String::operator=(const char* s) {
+  if(nameIndex) nameIndex->touched(*this);
   if(!s) {  clear();  return *this;  }
   uint ls = strlen(s);
   if(!ls) {  clear();  return *this;  }
@@ -940,6 +954,60 @@ uint rai::String::read(std::istream& is, const char* skipSymbols, const char* st
   return N;
 }
 
+//===========================================================================
+//
+// NameIndex
+//
+
+static const char* nameIndexKey(const rai::String& name) { return name.p ? name.p : ""; }
+
+void rai::NameIndex::clear() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  for(auto& it:map) for(Entry& e:it.second) e.name->nameIndex=nullptr;
+  map.clear();
+  renamed.clear();
+  built=false;
+}
+
+void rai::NameIndex::add(String& name, void* obj) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  CHECK(!name.nameIndex, "this name is already indexed");
+  map[nameIndexKey(name)].push_back({&name, obj});
+  name.nameIndex=this;
+}
+
+void rai::NameIndex::remove(String& name) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if(name.nameIndex==this) {
+    auto it = map.find(nameIndexKey(name));
+    CHECK(it!=map.end(), "indexed name '" <<name <<"' is not in the index");
+    std::vector<Entry>& E = it->second;
+    for(uint i=0; i<E.size(); i++) if(E[i].name==&name) { E.erase(E.begin()+i); break; }
+    if(!E.size()) map.erase(it);
+    name.nameIndex=nullptr;
+  } else {
+    for(uint i=0; i<renamed.size(); i++) if(renamed[i].name==&name) { renamed.erase(renamed.begin()+i); break; }
+  }
+}
+
+void rai::NameIndex::touched(String& name) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  auto it = map.find(nameIndexKey(name));
+  CHECK(it!=map.end(), "indexed name '" <<name <<"' is not in the index");
+  std::vector<Entry>& E = it->second;
+  for(uint i=0; i<E.size(); i++) if(E[i].name==&name) { renamed.push_back(E[i]); E.erase(E.begin()+i); break; }
+  if(!E.size()) map.erase(it);
+  name.nameIndex=nullptr; //further changes are not reported until re-indexed
+}
+
+const std::vector<rai::NameIndex::Entry>* rai::NameIndex::find(const char* name) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  for(Entry& e:renamed) { map[nameIndexKey(*e.name)].push_back(e); e.name->nameIndex=this; }
+  renamed.clear();
+  auto it = map.find(name ? name : "");
+  return it==map.end() ? nullptr : &it->second;
+}
+
 //===========================================================================
 //
 // FileToken
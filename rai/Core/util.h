@@ -17,6 +17,8 @@
 #include <climits>
 #include <mutex>
 #include <functional>
+#include <unordered_map>
+#include <vector>
 
 //----- if no system flag, I assume Linux
 #if !defined RAI_MSVC && !defined RAI_Cygwin && !defined RAI_Linux && !defined RAI_MinGW && !defined RAI_Darwin
@@ -152,6 +154,7 @@ double NNsdv(double x, double sdv);
 double clockTime(); //(really on the clock)
 double realTime(); //(since process start)
 double cpuTime();
+double threadCpuTime(); //(only the calling thread)
 std::string date(bool forFileName=false);
 void wait(double sec);
 bool wait(bool useX11=true);
@@ -217,6 +220,7 @@ struct String : public std::iostream {
   static const char* readStopSymbols; ///< default argument to read method (also called by operator>>)
   static int readEatStopSymbol;       ///< default argument to read method (also called by operator>>)
   void (*flushCallback)(String&);
+  struct NameIndex* nameIndex; ///< (internal) the index this string is a key of -- informed before any resize/assignment
 
   /// @name constructors
   String();
@@ -687,6 +691,8 @@ struct OpenGLDrawOptions{
   bool drawZlines=false;
 
   float pclPointSize=-1.;
+  uint meshBufferMinTriangles=1000; ///< meshes with at least this many triangles are drawn from GPU-resident buffers
+  bool meshBufferCheckContent=false; ///< debug: also hash the mesh data on each draw, to find changes not signalled via Mesh::changed()
 };
 struct GLDrawer {
   virtual void glDraw(OpenGL&) = 0;
@@ -702,6 +708,35 @@ struct NonCopyable {
   NonCopyable() = default;
 };
 
+//===========================================================================
+//
+/// a hash index from names to objects (frames, graph nodes) for lookups in large lists; the owner adds/removes
+/// objects on creation/deletion; renames are noticed via String::nameIndex (any resize or assignment of the
+/// name String) and re-indexed on the next find. Direct writes to single characters are not noticed.
+/// All methods lock the (recursive) mutex; hold it yourself while using the result of find().
+//
+
+namespace rai {
+struct NameIndex {
+  struct Entry { String* name; void* obj; };
+  std::unordered_map<std::string, std::vector<Entry>> map; ///< name -> objects (in no particular order)
+  std::vector<Entry> renamed; ///< entries whose name changed since they were indexed
+  std::recursive_mutex mutex;
+  bool built=false; ///< the owner has added all its objects
+
+  NameIndex() {}
+  NameIndex(const NameIndex&) {} ///< an index is never copied -- the copy indexes its owner's objects
+  NameIndex& operator=(const NameIndex&) { return *this; }
+  ~NameIndex() { clear(); }
+
+  void clear();
+  void add(String& name, void* obj);
+  void remove(String& name); ///< the owner must remove a name before it is destroyed
+  void touched(String& name); ///< called by the String before it changes
+  const std::vector<Entry>* find(const char* name);
+};
+}
+
 //===========================================================================
 //
 /// a mutexed cout
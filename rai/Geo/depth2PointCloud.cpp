@@ -8,11 +8,19 @@
 
 #include "depth2PointCloud.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 Depth2PointCloud::Depth2PointCloud(Var<floatA>& _depth, float _fx, float _fy, float _px, float _py)
   : Thread("Depth2PointCloud"),
     depth(this, _depth, true),
     fx(_fx), fy(_fy), px(_px), py(_py) {
   pose.set()->setZero();
+  stride = rai::getParameter<uint>("Depth2PointCloud/stride", 1);
+  floatPoints = rai::getParameter<bool>("Depth2PointCloud/floatPoints", false);
+  uint numThreads = rai::getParameter<uint>("Depth2PointCloud/numThreads", 1);
+  if(numThreads>1) pool = make_unique<ThreadPool>(numThreads);
   threadOpen();
 }
 
@@ -27,47 +35,112 @@ Depth2PointCloud::~Depth2PointCloud() {
 void Depth2PointCloud::step() {
   _depth = depth.get();
 
-  depthData2pointCloud(_points, _depth, fx, fy, px, py);
-
+  rays.set(_depth.d0, _depth.d1, fx, fy, px, py, stride);
   rai::Transformation _pose = pose.get(); //this is relative to "/base_link"
-  if(!_pose.isZero()) _pose.applyOnPointArray(_points);
+  if(floatPoints) {
+    depthData2pointCloud(_fpoints, _depth, rays, _pose, pool.get());
+    fpoints.set() = _fpoints;
+  } else {
+    depthData2pointCloud(_points, _depth, rays, _pose, pool.get());
+    points.set() = _points;
+  }
+}
 
-  points.set() = _points;
+//===========================================================================
+
+void DepthRays::set(uint _H, uint _W, float _fx, float _fy, float _px, float _py, uint _stride) {
+  CHECK(_fx>0, "need a focal length greater zero!(not implemented for ortho yet)");
+  CHECK(_stride>0, "");
+  if(std::isnan(_fy)) _fy = _fx;
+  if(std::isnan(_px)) _px = .5*_W;
+  if(std::isnan(_py)) _py = .5*_H;
+  if(_H==H && _W==W && _stride==stride && _fx==fx && _fy==fy && _px==px && _py==py) return;
+  H=_H; W=_W; stride=_stride; fx=_fx; fy=_fy; px=_px; py=_py;
+
+  rx.resize((W+stride-1)/stride);
+  for(uint j=0; j<rx.N; j++) rx(j) = (float(j*stride) - px) / fx;
+  ry.resize((H+stride-1)/stride);
+  for(uint i=0; i<ry.N; i++) ry(i) = -(float(i*stride) - py) / fy;
 }
 
-void depthData2pointCloud(arr& pts, const floatA& depth, float fx, float fy, float px, float py) {
-  uint H=depth.d0, W=depth.d1;
-
-  CHECK(fx>0, "need a focal length greater zero!(not implemented for ortho yet)");
-  if(std::isnan(fy)) fy = fx;
-  if(std::isnan(px)) px=.5*W;
-  if(std::isnan(py)) py=.5*H;
-
-  pts.resize(H*W, 3);
-  pts.setZero();
-  double* pt=pts.p;
-  float* de=depth.p;
-
-  for(uint i=0; i<H; i++) for(uint j=0; j<W; j++) {
-      float d = *(de++);
-      if(d>=0.) {
-        float x=j, y=i;
-#if 0 //slow
-        pts(k, 0) =  d * (x - px) / fx;
-        pts(k, 1) = -d * (y - py) / fy;
-        pts(k, 2) = -d;
-#else //fast
-        *(pt++) =  d * (x - px) / fx;
-        *(pt++) = -d * (y - py) / fy;
-        *(pt++) = -d;
-#endif
-      } else {
-        pt += 3;
+/// converts output rows [i0,i1): camera-frame point d*(rx, ry, -1), then R*x+t; invalid depths are set to 0
+template<class T> void depth2points_rows(T* pts, const float* depth, const DepthRays& rays, const float* R, const float* t, uint i0, uint i1) {
+  uint W=rays.rx.N, s=rays.stride;
+  for(uint i=i0; i<i1; i++) {
+    const float* de = depth + i*s*rays.W;
+    T* pt = pts + 3*i*W;
+    float ry = rays.ry(i);
+    uint j=0;
+#ifdef __SSE2__
+    if(std::is_same<T, float>::value && s==1) {
+      __m128 zero = _mm_setzero_ps(), y = _mm_set1_ps(ry);
+      __m128 R0=_mm_set1_ps(R[0]), R1=_mm_set1_ps(R[1]), R2=_mm_set1_ps(R[2]);
+      __m128 R3=_mm_set1_ps(R[3]), R4=_mm_set1_ps(R[4]), R5=_mm_set1_ps(R[5]);
+      __m128 R6=_mm_set1_ps(R[6]), R7=_mm_set1_ps(R[7]), R8=_mm_set1_ps(R[8]);
+      __m128 t0=_mm_set1_ps(t[0]), t1=_mm_set1_ps(t[1]), t2=_mm_set1_ps(t[2]);
+      float* out = (float*)pt;
+      for(; j+4<=W; j+=4, out+=12) {
+        __m128 d = _mm_max_ps(_mm_loadu_ps(de+j), zero); //negative or NaN depths -> 0
+        __m128 cx = _mm_mul_ps(d, _mm_loadu_ps(rays.rx.p+j));
+        __m128 cy = _mm_mul_ps(d, y);
+        __m128 cz = _mm_sub_ps(zero, d);
+        __m128 X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(R0, cx), _mm_mul_ps(R1, cy)), _mm_add_ps(_mm_mul_ps(R2, cz), t0));
+        __m128 Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(R3, cx), _mm_mul_ps(R4, cy)), _mm_add_ps(_mm_mul_ps(R5, cz), t1));
+        __m128 Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(R6, cx), _mm_mul_ps(R7, cy)), _mm_add_ps(_mm_mul_ps(R8, cz), t2));
+        //interleave to x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+        __m128 a = _mm_unpacklo_ps(X, Y), b = _mm_unpackhi_ps(X, Y);
+        _mm_storeu_ps(out, _mm_shuffle_ps(a, _mm_shuffle_ps(Z, X, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(out+4, _mm_shuffle_ps(_mm_shuffle_ps(Y, Z, _MM_SHUFFLE(1, 1, 1, 1)), b, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(out+8, _mm_shuffle_ps(_mm_shuffle_ps(Z, X, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
       }
     }
+#endif
+    for(; j<W; j++) {
+      float d = de[j*s];
+      if(!(d>=0.f)) d=0.f;
+      float cx = d*rays.rx.p[j], cy = d*ry, cz = -d;
+      pt[3*j+0] = R[0]*cx + R[1]*cy + R[2]*cz + t[0];
+      pt[3*j+1] = R[3]*cx + R[4]*cy + R[5]*cz + t[1];
+      pt[3*j+2] = R[6]*cx + R[7]*cy + R[8]*cz + t[2];
+    }
+  }
+}
+
+template<class T> void depth2points(rai::Array<T>& pts, const floatA& depth, const DepthRays& rays, const rai::Transformation& pose, ThreadPool* pool) {
+  CHECK(depth.nd==2 && depth.d0==rays.H && depth.d1==rays.W, "depth image does not match the rays (call rays.set)");
+  uint H=rays.ry.N, W=rays.rx.N;
+  pts.resize(H, W, 3);
+
+  float R[9], t[3];
+  double Rd[9];
+  pose.rot.getMatrix(Rd);
+  for(uint k=0; k<9; k++) R[k]=Rd[k];
+  t[0]=pose.pos.x; t[1]=pose.pos.y; t[2]=pose.pos.z;
+
+  if(!pool || pool->size()<2 || H<2*pool->size()) {
+    depth2points_rows<T>(pts.p, depth.p, rays, R, t, 0, H);
+  } else {
+    uint n = 4*pool->size(), chunk = (H+n-1)/n;
+    pool->parallelFor(n, [&](uint c, uint) {
+      uint i0 = c*chunk, i1 = rai::MIN(H, i0+chunk);
+      if(i0<i1) depth2points_rows<T>(pts.p, depth.p, rays, R, t, i0, i1);
+    });
+  }
+}
 
-  pts.reshape(H, W, 3);
+void depthData2pointCloud(floatA& pts, const floatA& depth, const DepthRays& rays, const rai::Transformation& pose, ThreadPool* pool) {
+  depth2points<float>(pts, depth, rays, pose, pool);
+}
 
+void depthData2pointCloud(arr& pts, const floatA& depth, const DepthRays& rays, const rai::Transformation& pose, ThreadPool* pool) {
+  depth2points<double>(pts, depth, rays, pose, pool);
+}
+
+void depthData2pointCloud(arr& pts, const floatA& depth, float fx, float fy, float px, float py) {
+  CHECK_EQ(depth.nd, 2, "need a depth image");
+  DepthRays rays;
+  rays.set(depth.d0, depth.d1, fx, fy, px, py);
+  depth2points<double>(pts, depth, rays, 0, nullptr); //identity pose: invalid depths give zero points
 }
 
 void depthData2pointCloud(arr& pts, const floatA& depth, const arr& Fxypxy) {
@@ -11,16 +11,32 @@
 #include "../Core/thread.h"
 #include "../Geo/geo.h"
 
+/// precomputed rays of a pinhole camera: output pixel (i,j) with depth d maps to the camera-frame point d*(rx(j), ry(i), -1);
+/// with stride>1 only every stride-th row and column of the depth image is converted
+struct DepthRays {
+  floatA rx, ry;
+  uint H=0, W=0, stride=0;
+  float fx=0.f, fy=0.f, px=0.f, py=0.f;
+
+  void set(uint H, uint W, float fx, float fy=NAN, float px=NAN, float py=NAN, uint stride=1); ///< only recomputes if a parameter changed
+};
+
 struct Depth2PointCloud : Thread {
   //inputs
   Var<floatA> depth;
   Var<rai::Transformation> pose;
   //outputs
   Var<arr> points;
+  Var<floatA> fpoints; ///< filled instead of points if floatPoints (Depth2PointCloud/floatPoints): no conversion to double, uses the SSE float kernel
 
   float fx, fy, px, py;
+  uint stride;
+  bool floatPoints;
   floatA _depth;
   arr _points;
+  floatA _fpoints;
+  DepthRays rays;
+  std::unique_ptr<ThreadPool> pool;
 
   Depth2PointCloud(Var<floatA>& _depth, float _fx=NAN, float _fy=NAN, float _px=NAN, float _py=NAN);
   Depth2PointCloud(Var<floatA>& _depth, const arr& Fxypxy);
@@ -36,3 +52,8 @@ void depthData2point(arr& pt, const arr& Fxypxy);
 void depthData2pointCloud(arr& pts, const floatA& depth, float fx, float fy, float px, float py);
 void depthData2pointCloud(arr& pts, const floatA& depth, const arr& Fxypxy);
 
+/// fused conversion and transformation (with the camera pose) of a depth image into (H/stride, W/stride, 3) points;
+/// invalid (negative) depths give the point pose.pos; rows are split across the pool's threads if one is given
+void depthData2pointCloud(floatA& pts, const floatA& depth, const DepthRays& rays, const rai::Transformation& pose=0, ThreadPool* pool=nullptr);
+void depthData2pointCloud(arr& pts, const floatA& depth, const DepthRays& rays, const rai::Transformation& pose=0, ThreadPool* pool=nullptr);
+
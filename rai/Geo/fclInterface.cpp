@@ -62,12 +62,59 @@ rai::FclInterface::FclInterface(const rai::Array<ptr<Mesh>>& geometries, double
   manager->setup();
 }
 
+rai::FclInterface::FclInterface(const FclInterface& other)
+  : convexGeometryData(other.convexGeometryData), cutoff(other.cutoff) {
+  for(fcl::CollisionObject* obj:other.objects) {
+    auto model = std::const_pointer_cast<fcl::CollisionGeometry>(obj->collisionGeometry());
+    fcl::CollisionObject* copy = new fcl::CollisionObject(model, fcl::Transform3f());
+    copy->setUserData(obj->getUserData());
+    objects.push_back(copy);
+  }
+
+  manager = make_shared<fcl::DynamicAABBTreeCollisionManager>();
+  manager->registerObjects(objects);
+  manager->setup();
+}
+
 rai::FclInterface::~FclInterface() {
   for(size_t i = 0; i < objects.size(); ++i)
     delete objects[i];
 }
 
 void rai::FclInterface::step(const arr& X) {
+  updateObjects(X);
+
+  collisions.clear();
+  manager->collide(this, BroadphaseCallback);
+  collisions.reshape(collisions.N/2, 2);
+}
+
+void rai::FclInterface::step(const arr& X, const boolA& query) {
+  CHECK_EQ(query.N, convexGeometryData.N, "");
+  updateObjects(X);
+
+  collisions.clear();
+  for(auto* obj:objects) {
+    uint i = (long int)obj->getUserData();
+    if(query(i)) manager->collide(obj, this, BroadphaseCallback);
+  }
+  collisions.reshape(collisions.N/2, 2);
+
+  //-- each query also returns the object itself, and pairs of two queried objects are returned twice
+  uintA pairs;
+  pairs.resize(collisions.d0, 2);
+  uint n=0;
+  for(uint k=0; k<collisions.d0; k++) {
+    uint a=collisions(k, 0), b=collisions(k, 1);
+    if(a==b) continue;
+    if(query(a) && query(b) && a>b) continue;
+    pairs(n, 0)=a;  pairs(n, 1)=b;  n++;
+  }
+  pairs.resizeCopy(n, 2);
+  collisions = pairs;
+}
+
+void rai::FclInterface::updateObjects(const arr& X) {
   CHECK_EQ(X.nd, 2, "");
   CHECK_EQ(X.d0, convexGeometryData.N, "");
   CHECK_EQ(X.d1, 7, "");
@@ -81,10 +128,6 @@ void rai::FclInterface::step(const arr& X) {
   }
   manager->update();
 
-  collisions.clear();
-  manager->collide(this, BroadphaseCallback);
-  collisions.reshape(collisions.N/2, 2);
-
   X_lastQuery = X;
 }
 
@@ -117,6 +160,9 @@ bool rai::FclInterface::BroadphaseCallback(fcl::CollisionObject* o1, fcl::Collis
 
 #else //RAI_FCL
 rai::FclInterface::FclInterface(const Array<ptr<Mesh>>& _geometries, double _cutoff) { NICO }
+rai::FclInterface::FclInterface(const FclInterface& other) { NICO }
 rai::FclInterface::~FclInterface() { NICO }
 void rai::FclInterface::step(const arr& X) { NICO }
+void rai::FclInterface::step(const arr& X, const boolA& query) { NICO }
+void rai::FclInterface::updateObjects(const arr& X) { NICO }
 #endif
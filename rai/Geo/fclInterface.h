@@ -28,11 +28,16 @@ struct FclInterface {
   arr X_lastQuery;  //memory to check whether an object has moved in consecutive queries
 
   FclInterface(const Array<ptr<Mesh>>& geometries, double _cutoff=0.);
+  FclInterface(const FclInterface& other); ///< shares the (constant) collision geometries, but has own objects and broadphase manager -> use one copy per thread for concurrent queries
   ~FclInterface();
 
   void step(const arr& X);
+  void step(const arr& X, const boolA& query); ///< only returns collisions that involve at least one object with query(i)=true
 
-private: //called by collision callback
+private:
+  void updateObjects(const arr& X);
+
+  //called by collision callback
   void addCollision(void* userData1, void* userData2);
   static bool BroadphaseCallback(fcl::CollisionObject* o1, fcl::CollisionObject* o2, void* cdata_);
 };
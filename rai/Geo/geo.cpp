@@ -13,6 +13,13 @@
 #ifdef RAI_GL
 #  include <GL/glu.h>
 #endif
+#if defined(__AVX2__) && defined(__FMA__)
+#  include <immintrin.h>
+#  define RAI_GEO_AVX
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#  define RAI_GEO_SSE
+#endif
 
 #pragma GCC diagnostic ignored "-Wclass-memaccess"
 
@@ -29,6 +36,72 @@ rai::Vector& NoVector = __NoVector;
 rai::Transformation __NoTransformation;
 rai::Transformation& NoTransformation = __NoTransformation;
 
+//===========================================================================
+//
+// SIMD kernels (AVX2/FMA when compiled with SIMD=1, otherwise SSE2 or scalar)
+//
+
+namespace rai {
+
+/// a = b*c for quaternions stored as (w,x,y,z); a may alias b or c
+static inline void quat_mult(double* a, const double* b, const double* c) {
+#ifdef RAI_GEO_AVX
+  __m256d C = _mm256_loadu_pd(c);
+  __m256d Cs = _mm256_permute2f128_pd(C, C, 1);                                                  //(y,z,w,x)
+  __m256d A = _mm256_mul_pd(_mm256_set1_pd(b[0]), C);
+  A = _mm256_fmadd_pd(_mm256_set1_pd(b[1]), _mm256_xor_pd(_mm256_permute_pd(C, 5), _mm256_set_pd(0., -0., 0., -0.)), A);  //(-x,w,-z,y)
+  A = _mm256_fmadd_pd(_mm256_set1_pd(b[2]), _mm256_xor_pd(Cs, _mm256_set_pd(-0., 0., 0., -0.)), A);                       //(-y,z,w,-x)
+  A = _mm256_fmadd_pd(_mm256_set1_pd(b[3]), _mm256_xor_pd(_mm256_permute_pd(Cs, 5), _mm256_set_pd(0., 0., -0., -0.)), A); //(-z,-y,x,w)
+  _mm256_storeu_pd(a, A);
+#else
+  double bw=b[0], bx=b[1], by=b[2], bz=b[3];
+  double cw=c[0], cx=c[1], cy=c[2], cz=c[3];
+  a[0] = bw*cw - bx*cx - by*cy - bz*cz;
+  a[1] = bw*cx + bx*cw + by*cz - bz*cy;
+  a[2] = bw*cy + by*cw + bz*cx - bx*cz;
+  a[3] = bw*cz + bz*cw + bx*cy - by*cx;
+#endif
+}
+
+/// p <- R*p + t for n points stored contiguously as (n,3); R is a row-major 3x3 matrix
+static void transformPoints(double* p, uint n, const double* R, const double* t) {
+#if defined(RAI_GEO_AVX)
+  __m256d c0 = _mm256_setr_pd(R[0], R[3], R[6], 0.);
+  __m256d c1 = _mm256_setr_pd(R[1], R[4], R[7], 0.);
+  __m256d c2 = _mm256_setr_pd(R[2], R[5], R[8], 0.);
+  __m256d T = _mm256_setr_pd(t[0], t[1], t[2], 0.);
+  for(double* pstop=p+3*n; p<pstop; p+=3) {
+    __m256d v = _mm256_fmadd_pd(c0, _mm256_broadcast_sd(p), T);
+    v = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(p+1), v);
+    v = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(p+2), v);
+    _mm_storeu_pd(p, _mm256_castpd256_pd128(v));
+    _mm_store_sd(p+2, _mm256_extractf128_pd(v, 1));
+  }
+#elif defined(RAI_GEO_SSE)
+  __m128d c0 = _mm_setr_pd(R[0], R[3]);
+  __m128d c1 = _mm_setr_pd(R[1], R[4]);
+  __m128d c2 = _mm_setr_pd(R[2], R[5]);
+  __m128d T = _mm_setr_pd(t[0], t[1]);
+  for(double* pstop=p+3*n; p<pstop; p+=3) {
+    double x=p[0], y=p[1], z=p[2];
+    __m128d v = _mm_add_pd(T, _mm_mul_pd(c0, _mm_set1_pd(x)));
+    v = _mm_add_pd(v, _mm_mul_pd(c1, _mm_set1_pd(y)));
+    v = _mm_add_pd(v, _mm_mul_pd(c2, _mm_set1_pd(z)));
+    p[2] = R[6]*x + R[7]*y + R[8]*z + t[2];
+    _mm_storeu_pd(p, v);
+  }
+#else
+  for(double* pstop=p+3*n; p<pstop; p+=3) {
+    double x=p[0], y=p[1], z=p[2];
+    p[0] = R[0]*x + R[1]*y + R[2]*z + t[0];
+    p[1] = R[3]*x + R[4]*y + R[5]*z + t[1];
+    p[2] = R[6]*x + R[7]*y + R[8]*z + t[2];
+  }
+#endif
+}
+
+} //namespace rai
+
 namespace rai {
 
 bool Vector::operator!() const { return this==&NoVector; }
@@ -565,6 +638,9 @@ Quaternion& Quaternion::addZ(double radians) {
 
 void Quaternion::append(const Quaternion& q) {
   if(q.isZero) return;
+#ifdef RAI_GEO_AVX
+  quat_mult(&w, &w, &q.w);
+#else
   double aw = w*q.w;
   double ax = x*q.w;
   double ay = y*q.w;
@@ -572,7 +648,9 @@ void Quaternion::append(const Quaternion& q) {
   if(q.x) { aw -= x*q.x;  ax += w*q.x;  ay += z*q.x;  az -= y*q.x; }
   if(q.y) { aw -= y*q.y;  ax -= z*q.y;  ay += w*q.y;  az += x*q.y; }
   if(q.z) { aw -= z*q.z;  ax += y*q.z;  ay -= x*q.z;  az += w*q.z; }
-  w=aw; x=ax; y=ay; z=az; isZero=false;
+  w=aw; x=ax; y=ay; z=az;
+#endif
+  isZero=false;
 }
 
 /// set the quad
@@ -939,8 +1017,11 @@ arr Quaternion::getEulerRPY() const {
 }
 
 void Quaternion::applyOnPointArray(arr& pts) {
-  arr R = ~getArr(); //transposed, to make it applicable to an n-times-3 array
-  pts = pts * R;
+  CHECK((pts.nd==2 && pts.d1==3) || (pts.nd==3 && pts.d2==3), "wrong pts dimensions for rotation:" <<pts.dim());
+  if(isZero) return;
+  double R[9], t[3]= {0., 0., 0.};
+  getMatrix(R);
+  transformPoints(pts.p, pts.N/3, R, t);
 }
 
 /// this is a 3-by-4 matrix $J$, giving the angular velocity vector $w = J \dot q$  induced by a $\dot q$
@@ -1018,11 +1099,8 @@ Quaternion operator*(const Quaternion& b, const Quaternion& c) {
   if(c.isZero) return b;
   if(b.isZero) return c;
   Quaternion a;
-#if 0
-  a.w = b.w*c.w - b.x*c.x - b.y*c.y - b.z*c.z;
-  a.x = b.w*c.x + b.x*c.w + b.y*c.z - b.z*c.y;
-  a.y = b.w*c.y + b.y*c.w + b.z*c.x - b.x*c.z;
-  a.z = b.w*c.z + b.z*c.w + b.x*c.y - b.y*c.x;
+#ifdef RAI_GEO_AVX
+  quat_mult(&a.w, &b.w, &c.w); //dense SIMD product beats the branches below
 #else
   a.w = b.w*c.w;
   a.x = b.x*c.w;
@@ -1442,11 +1520,11 @@ arr& Transformation::applyOnPointArray(arr& pts) const {
     LOG(-1) <<"wrong pts dimensions for transformation:" <<pts.dim();
     return pts;
   }
-  if(!rot.isZero) {
-    arr R = ~rot.getArr(); //transposed, only to make it applicable to an n-times-3 array
-    pts = pts * R;
-  }
-  if(!pos.isZero) {
+  if(!rot.isZero) { //rotation and translation in one fused pass
+    double R[9];
+    rot.getMatrix(R);
+    transformPoints(pts.p, pts.N/3, R, &pos.x);
+  } else if(!pos.isZero) {
     for(double* p=pts.p, *pstop=pts.p+pts.N; p<pstop; p+=3) {
       p[0] += pos.x;
       p[1] += pos.y;
@@ -19,9 +19,14 @@
 #endif
 
 #ifdef RAI_GL
+#  define GL_GLEXT_PROTOTYPES
 #  include <GL/gl.h>
+#  include <GL/glext.h>
+#  include "../Gui/opengl.h"
 #endif
 
+#include <atomic>
+
 extern void glColorId(uint id);
 
 //#define sphereSweptFactor *1.08
@@ -38,12 +43,24 @@ template<> const char* rai::Enum<rai::ShapeType>::names []= {
 // Mesh code
 //
 
+rai::UniqueId::UniqueId() {
+  static std::atomic<uint64_t> count(0);
+  id = ++count;
+}
+
+//==============================================================================
+
+static std::atomic<uint64_t> meshVersionCounter(0);
+
 rai::Mesh::Mesh()
   : glX(0)
     /*parsing_pos_start(0),
-    parsing_pos_end(std::numeric_limits<long>::max())*/{}
+    parsing_pos_end(std::numeric_limits<long>::max())*/{ changed(); }
+
+void rai::Mesh::changed() { version = ++meshVersionCounter; }
 
 void rai::Mesh::clear() {
+  changed();
   V.clear(); Vn.clear();
   if(C.nd==2) C.clear();
   T.clear(); Tn.clear();
@@ -51,6 +68,7 @@ void rai::Mesh::clear() {
 }
 
 void rai::Mesh::setBox() {
+  changed();
   clear();
   double verts[24] = {
     -.5, -.5, -.5,
@@ -80,11 +98,13 @@ void rai::Mesh::setBox() {
 }
 
 void rai::Mesh::setDot() {
+  changed();
   clear();
   V.resize(1, 3).setZero();
 }
 
 void rai::Mesh::setLine(double l) {
+  changed();
   clear();
   V.resize(2, 3).setZero();
   V(0, 2) = -.5*l;
@@ -92,6 +112,7 @@ void rai::Mesh::setLine(double l) {
 }
 
 void rai::Mesh::setQuad(double x_width, double y_width, const byteA& _texImg){
+  changed();
   clear();
   V = {
     -.5*x_width, -.5*y_width, 0,
@@ -113,6 +134,7 @@ void rai::Mesh::setQuad(double x_width, double y_width, const byteA& _texImg){
 }
 
 void rai::Mesh::setTetrahedron() {
+  changed();
   clear();
   double s2=RAI_SQRT2/3., s6=sqrt(6.)/3.;
   double verts[12] = { 0., 0., 1., 2.*s2, 0., -1./3., -s2, s6, -1./3., -s2, -s6, -1./3. };
@@ -124,6 +146,7 @@ void rai::Mesh::setTetrahedron() {
 }
 
 void rai::Mesh::setOctahedron() {
+  changed();
   clear();
   double verts[18] = {
     1, 0, 0,
@@ -144,6 +167,7 @@ void rai::Mesh::setOctahedron() {
 }
 
 void rai::Mesh::setDodecahedron() {
+  changed();
   clear();
   double a = 1/sqrt(3.), b = sqrt((3.-sqrt(5.))/6.), c=sqrt((3.+sqrt(5.))/6.);
   double verts[60] = {
@@ -183,6 +207,7 @@ void rai::Mesh::setDodecahedron() {
 }
 
 void rai::Mesh::setSphere(uint fineness) {
+  changed();
   setOctahedron();
 //  setDodecahedron();
 //  setTetrahedron();
@@ -194,6 +219,7 @@ void rai::Mesh::setSphere(uint fineness) {
 }
 
 void rai::Mesh::setHalfSphere(uint fineness) {
+  changed();
   setOctahedron();
   V.resizeCopy(5, 3);
   T.resizeCopy(4, 3);
@@ -205,6 +231,7 @@ void rai::Mesh::setHalfSphere(uint fineness) {
 }
 
 void rai::Mesh::setCylinder(double r, double l, uint fineness) {
+  changed();
   clear();
   uint div = 4 * (1 <<fineness);
   V.resize(2*div+2, 3);
@@ -243,6 +270,7 @@ void rai::Mesh::setCylinder(double r, double l, uint fineness) {
 }
 
 void rai::Mesh::setSSBox(double x_width, double y_width, double z_height, double r, uint fineness) {
+  changed();
   CHECK(r>=0. && x_width>=2.*r && y_width>=2.*r && z_height>=2.*r, "width/height includes radius!");
   setSphere(fineness);
   scale(r sphereSweptFactor);
@@ -255,6 +283,7 @@ void rai::Mesh::setSSBox(double x_width, double y_width, double z_height, double
 }
 
 void rai::Mesh::setCapsule(double r, double l, uint fineness) {
+  changed();
   uint i;
   setSphere(fineness);
   scale(r);
@@ -266,6 +295,7 @@ void rai::Mesh::setCapsule(double r, double l, uint fineness) {
   Array, the elements of which are indices referring to vertices in
   the vertex list (V) */
 void rai::Mesh::setGrid(uint X, uint Y) {
+  changed();
   CHECK(X>1 && Y>1, "grid has to be at least 2x2");
   CHECK_EQ(V.d0, X*Y, "don't have X*Y mesh-vertices to create grid faces");
   uint i, j, k=T.d0;
@@ -281,6 +311,7 @@ void rai::Mesh::setGrid(uint X, uint Y) {
 }
 
 rai::Mesh& rai::Mesh::setRandom(uint vertices) {
+  changed();
   clear();
   V.resize(vertices, 3);
   rndUniform(V, -1., 1.);
@@ -291,6 +322,7 @@ rai::Mesh& rai::Mesh::setRandom(uint vertices) {
 }
 
 void rai::Mesh::subDivide() {
+  changed();
   uint v=V.d0, t=T.d0;
   V.resizeCopy(v+3*t, 3);
   uintA newT(4*t, 3);
@@ -311,6 +343,7 @@ void rai::Mesh::subDivide() {
 }
 
 void rai::Mesh::subDivide(uint i) {
+  changed();
   uint v=V.d0, t=T.d0;
   V.resizeCopy(v+3, 3);
   T.resizeCopy(t+3, 3);
@@ -325,34 +358,40 @@ void rai::Mesh::subDivide(uint i) {
   T(t, 0)=v+2; T(t, 1)=v+1; T(t, 2)=c;   t++;
 }
 
-void rai::Mesh::scale(double f) {  V *= f; }
+void rai::Mesh::scale(double f) {  V *= f;  changed(); }
 
 void rai::Mesh::scale(double sx, double sy, double sz) {
+  changed();
   uint i;
   for(i=0; i<V.d0; i++) {  V(i, 0)*=sx;  V(i, 1)*=sy;  V(i, 2)*=sz;  }
 }
 
 void rai::Mesh::translate(double dx, double dy, double dz) {
+  changed();
   uint i;
   for(i=0; i<V.d0; i++) {  V(i, 0)+=dx;  V(i, 1)+=dy;  V(i, 2)+=dz;  }
 }
 
 void rai::Mesh::translate(const arr& d) {
+  changed();
   CHECK_EQ(d.N, 3, "");
   translate(d.elem(0), d.elem(1), d.elem(2));
 }
 
 void rai::Mesh::transform(const rai::Transformation& t) {
+  changed();
   t.applyOnPointArray(V);
 }
 
 rai::Vector rai::Mesh::center() {
+  changed();
   arr Vmean = mean(V);
   for(uint i=0; i<V.d0; i++) V[i]() -= Vmean;
   return Vector(Vmean);
 }
 
 void rai::Mesh::box() {
+  changed();
   double x, X, y, Y, z, Z, m;
   x=X=V(0, 0);
   y=Y=V(0, 1);
@@ -373,6 +412,7 @@ void rai::Mesh::box() {
 }
 
 void rai::Mesh::addMesh(const Mesh& mesh2, const rai::Transformation& X) {
+  changed();
   uint n=V.d0, tn=tex.d0, t=T.d0, tt=Tt.d0;
   V.append(mesh2.V);
   if(V.N==C.N && mesh2.V.N==mesh2.C.N) C.append(mesh2.C); else C.clear();
@@ -395,6 +435,7 @@ void rai::Mesh::addMesh(const Mesh& mesh2, const rai::Transformation& X) {
 }
 
 void rai::Mesh::makeConvexHull() {
+  changed();
   if(V.d0<=1) return;
 #if 1
   V = getHull(V, T);
@@ -429,6 +470,7 @@ void rai::Mesh::makeConvexHull() {
 }
 
 void rai::Mesh::makeTriangleFan() {
+  changed();
   T.clear();
   for(uint i=1; i+1<V.d0; i++) {
     T.append(TUP(0, i, i+1));
@@ -438,6 +480,7 @@ void rai::Mesh::makeTriangleFan() {
 }
 
 void rai::Mesh::makeLineStrip() {
+  changed();
   T.resize(V.d0-1, 2);
 //  T[0] = {V.d0-1, 0};
   for(uint i=1; i<V.d0; i++) {
@@ -446,6 +489,7 @@ void rai::Mesh::makeLineStrip() {
 }
 
 void rai::Mesh::setSSCvx(const arr& core, double r, uint fineness) {
+  changed();
   if(r>0.) {
     Mesh ball;
     ball.setSphere(fineness);
@@ -486,6 +530,7 @@ arr MinkowskiSum(const arr& A, const arr& B) {
   all adjacent triangles that are in the triangle list or member of
   a strip */
 void rai::Mesh::computeNormals() {
+  changed();
   CHECK(T.N, "can't compute normals for a point cloud");
   Vector a, b, c;
   Tn.resize(T.d0, 3);
@@ -637,6 +682,7 @@ void permuteVertices(rai::Mesh& m, uintA& p) {
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void rai::Mesh::deleteUnusedVertices() {
+  changed();
   if(!V.N) return;
   uintA p;
   uintA u;
@@ -668,6 +714,7 @@ bool COMP(uint i, uint j) {
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void rai::Mesh::fuseNearVertices(double tol) {
+  changed();
   if(!V.N) return;
   uintA p;
   uint i, j;
@@ -738,6 +785,7 @@ void getTriNormals(const rai::Mesh& m, arr& Tn) {
 
 /// flips all faces
 void rai::Mesh::flipFaces() {
+  changed();
   uint i, a;
   for(i=0; i<T.d0; i++) {
     a=T(i, 0);
@@ -748,6 +796,7 @@ void rai::Mesh::flipFaces() {
 
 /// check whether this is really a closed mesh, and flip inconsistent faces
 void rai::Mesh::clean() {
+  changed();
   uint i, j, idist=0;
   Vector a, b, c, m;
   double mdist=0.;
@@ -955,6 +1004,7 @@ void getTriNeighborsList(const rai::Mesh& m, uintA& Tt, intA& TT) {
 }
 
 void rai::Mesh::skin(uint start) {
+  changed();
   intA TT;
   uintA Tt;
   getTriNeighborsList(*this, Tt, TT);
@@ -1109,6 +1159,7 @@ void rai::Mesh::readFile(const char* filename) {
 }
 
 void rai::Mesh::read(std::istream& is, const char* fileExtension, const char* filename) {
+  changed();
   if(!strcmp(fileExtension, "arr")) { readArr(is); }
   else if(!strcmp(fileExtension, "off")) { readOffFile(is); }
   else if(!strcmp(fileExtension, "ply")) { readPLY(filename); }
@@ -1133,6 +1184,7 @@ void rai::Mesh::writeTriFile(const char* filename) {
 }
 
 void rai::Mesh::readTriFile(std::istream& is) {
+  changed();
   uint i, nV, nT;
   is >>PARSE("TRI") >>nV >>nT;
   V.resize(nV, 3);
@@ -1151,6 +1203,7 @@ void rai::Mesh::writeOffFile(const char* filename) {
 }
 
 void rai::Mesh::readOffFile(std::istream& is) {
+  changed();
   uint i, k, nVertices, nFaces, nEdges, alpha;
   bool color;
   rai::String tag;
@@ -1175,6 +1228,7 @@ void rai::Mesh::readOffFile(std::istream& is) {
 }
 
 void rai::Mesh::readPlyFile(std::istream& is) {
+  changed();
   uint i, k, nVertices, nFaces;
   rai::String str;
   is >>PARSE("ply") >>PARSE("format") >>str;
@@ -1268,6 +1322,7 @@ bool ply_check_property(PlyElement* elem, const char* prop_name) {
 }
 
 void rai::Mesh::readPLY(const char* fn) {
+  changed();
   struct PlyFace {    unsigned char nverts;  int* verts; };
   struct Vertex {    double x,  y,  z ;  byte r, g, b; };
   uint _nverts=0, _ntrigs=0;
@@ -1373,6 +1428,7 @@ void rai::Mesh::writeArr(std::ostream& os) {
 }
 
 void rai::Mesh::readArr(std::istream& is) {
+  changed();
   V.readTagged(is, "V");
   T.readTagged(is, "T");
   C.readTagged(is, "C");
@@ -1428,6 +1484,23 @@ uintA getSubMeshPositions(const char* filename) {
 
 extern void glColor(float r, float g, float b, float alpha);
 
+/// content hash of the mesh data -- only a debug check (OpenGLDrawOptions::meshBufferCheckContent) that all changes were signalled via Mesh::changed()
+static uint64_t glContentHash(const arr& V, const arr& Vn, const arr& C, const uintA& T) {
+  uint64_t h[4] = {V.N, Vn.N, C.N, T.N}; //4 independent FNV-1a lanes over 64bit words
+  auto add = [&h](const void* p, size_t bytes) {
+    const uint64_t* w = (const uint64_t*)p;
+    size_t n = bytes/8, i=0;
+    for(; i+4<=n; i+=4) for(uint k=0; k<4; k++) h[k] = (h[k]^w[i+k])*0x100000001b3ull;
+    for(; i<n; i++) h[0] = (h[0]^w[i])*0x100000001b3ull;
+    if(bytes%8) { uint64_t r=0; memcpy(&r, w+n, bytes%8); h[1] = (h[1]^r)*0x100000001b3ull; }
+  };
+  add(V.p, V.N*sizeof(double));
+  add(Vn.p, Vn.N*sizeof(double));
+  add(C.p, C.N*sizeof(double));
+  add(T.p, T.N*sizeof(uint));
+  return h[0] ^ (h[1]*31) ^ (h[2]*961) ^ (h[3]*29791);
+}
+
 /// GL routine to draw a rai::Mesh
 void rai::Mesh::glDraw(struct OpenGL& gl) {
   if(glDrawOptions(gl).drawColors) {
@@ -1534,14 +1607,55 @@ void rai::Mesh::glDraw(struct OpenGL& gl) {
       if(tex.N) glEnableClientState(GL_TEXTURE_COORD_ARRAY); else glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     }
 
-    glVertexPointer(3, GL_DOUBLE, 0, V.p);
-    if(glDrawOptions(gl).drawColors) {
-      glNormalPointer(GL_DOUBLE, 0, Vn.p);
-      if(C.N==V.N) glColorPointer(3, GL_DOUBLE, 0, C.p);
-      if(tex.N) glTexCoordPointer(2, GL_DOUBLE, 0, tex.p);
-    }
+    if(T.d0>=glDrawOptions(gl).meshBufferMinTriangles && !tex.N) { //large mesh: draw from a GPU-resident copy, uploaded only when the data changed
+      OpenGL::GLBuffer& B = gl.meshBuffers[glId.id];
+      B.lastUsed = gl.drawCount;
+      bool withColors = (C.N==V.N);
+      //cheap change detection: the version stamp plus memory and sizes (catches reallocations without changed())
+      std::size_t fingerprint = std::hash<uint64_t>()(version);
+      for(std::size_t x: {(std::size_t)V.p, (std::size_t)V.N, (std::size_t)Vn.p, (std::size_t)Vn.N, (std::size_t)C.p, (std::size_t)C.N, (std::size_t)T.p, (std::size_t)T.N})
+        fingerprint ^= std::hash<std::size_t>()(x) + 0x9e3779b9 + (fingerprint<<6) + (fingerprint>>2);
+      if(!B.vbo) { glGenBuffers(1, &B.vbo); glGenBuffers(1, &B.ibo);  B.fingerprint = ~fingerprint; }
+      glBindBuffer(GL_ARRAY_BUFFER, B.vbo);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, B.ibo);
+      if(glDrawOptions(gl).meshBufferCheckContent) {
+        uint64_t h = glContentHash(V, Vn, C, T);
+        if(B.fingerprint==fingerprint && B.contentHash && B.contentHash!=h) {
+          LOG(-1) <<"mesh data changed without Mesh::changed() -- re-uploading";
+          B.fingerprint = ~fingerprint;
+        }
+        B.contentHash = h;
+      }
+      if(B.fingerprint!=fingerprint) {
+        floatA data(V.N + Vn.N + (withColors?C.N:0));
+        float* d=data.p;
+        for(double x:V) *(d++)=x;
+        for(double x:Vn) *(d++)=x;
+        if(withColors) for(double x:C) *(d++)=x;
+        B.offsetNormals = V.N*sizeof(float);
+        B.offsetColors = (V.N+Vn.N)*sizeof(float);
+        glBufferData(GL_ARRAY_BUFFER, data.N*sizeof(float), data.p, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, T.N*sizeof(uint), T.p, GL_STATIC_DRAW);
+        B.fingerprint = fingerprint;
+      }
+      glVertexPointer(3, GL_FLOAT, 0, 0);
+      if(glDrawOptions(gl).drawColors) {
+        glNormalPointer(GL_FLOAT, 0, (void*)B.offsetNormals);
+        if(withColors) glColorPointer(3, GL_FLOAT, 0, (void*)B.offsetColors);
+      }
+      glDrawElements(GL_TRIANGLES, T.N, GL_UNSIGNED_INT, 0);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    } else {
+      glVertexPointer(3, GL_DOUBLE, 0, V.p);
+      if(glDrawOptions(gl).drawColors) {
+        glNormalPointer(GL_DOUBLE, 0, Vn.p);
+        if(C.N==V.N) glColorPointer(3, GL_DOUBLE, 0, C.p);
+        if(tex.N) glTexCoordPointer(2, GL_DOUBLE, 0, tex.p);
+      }
 
-    glDrawElements(GL_TRIANGLES, T.N, GL_UNSIGNED_INT, T.p);
+      glDrawElements(GL_TRIANGLES, T.N, GL_UNSIGNED_INT, T.p);
+    }
 
     if(C.N) glEnable(GL_LIGHTING);
 
@@ -1809,10 +1923,12 @@ double GJK_distance(rai::Mesh& mesh1, rai::Mesh& mesh2,
 #  include "Lewiner/MarchingCubes.h"
 
 void rai::Mesh::setImplicitSurface(ScalarFunction f, double lo, double hi, uint res) {
+  changed();
   setImplicitSurface(f, lo, hi, lo, hi, lo, hi, res);
 }
 
 void rai::Mesh::setImplicitSurface(ScalarFunction f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res) {
+  changed();
   MarchingCubes mc(res, res, res);
   mc.init_all() ;
 
@@ -1850,6 +1966,7 @@ void rai::Mesh::setImplicitSurface(ScalarFunction f, double xLo, double xHi, dou
 }
 
 void rai::Mesh::setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi){
+  changed();
   CHECK_EQ(gridValues.nd, 3, "");
 
   MarchingCubes mc(gridValues.d0, gridValues.d1, gridValues.d2);
@@ -1884,11 +2001,13 @@ void rai::Mesh::setImplicitSurface(const arr& gridValues, const arr& lo, const a
 
 #else //Lewiner
 void rai::Mesh::setImplicitSurface(ScalarFunction f, double lo, double hi, uint res) {
+  changed();
   NICO
 }
 #endif
 
 void rai::Mesh::setImplicitSurfaceBySphereProjection(ScalarFunction f, double rad, uint fineness){
+  changed();
   setSphere(fineness);
   scale(rad);
 
@@ -22,6 +22,15 @@ namespace rai {
 
 enum ShapeType { ST_none=-1, ST_box=0, ST_sphere, ST_capsule, ST_mesh, ST_cylinder, ST_marker, ST_pointCloud, ST_ssCvx, ST_ssBox, ST_ssCylinder, ST_ssBoxElip, ST_quad, ST_camera };
 
+//===========================================================================
+/// an id that is unique per object -- copies get a fresh one
+struct UniqueId {
+  uint64_t id;
+  UniqueId();
+  UniqueId(const UniqueId&) : UniqueId() {}
+  UniqueId& operator=(const UniqueId&) { return *this; }
+};
+
 //===========================================================================
 /// a mesh (arrays of vertices, triangles, colors & normals)
 struct Mesh : GLDrawer {
@@ -41,6 +50,8 @@ struct Mesh : GLDrawer {
   shared_ptr<ANN> ann;
 
   rai::Transformation glX; ///< transform (only used for drawing! Otherwise use applyOnPoints)  (optional)
+  UniqueId glId;        ///< key of the GPU-resident copy of large meshes (see glDraw)
+  uint64_t version=0;   ///< stamp of the last change of V, Vn, C or T (set by all mutators below; unique across meshes, so copies keep it)
 
   long parsing_pos_start;
   long parsing_pos_end;
@@ -49,6 +60,8 @@ struct Mesh : GLDrawer {
 
   Mesh();
 
+  void changed(); ///< call after writing into V, Vn, C or T directly (not needed after the methods below) -- e.g., to re-upload the GPU copy
+
   /// @name set or create
   void clear();
   void setBox();
@@ -0,0 +1,152 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "voxelGrid.h"
+
+//===========================================================================
+
+namespace rai {
+
+//voxel coordinates are packed with 21 bits each (offset binary), i.e., +-1M voxels per dimension
+static const int64_t VOXEL_BITS = 21;
+static const int64_t VOXEL_OFFSET = int64_t(1)<<(VOXEL_BITS-1);
+static const int64_t VOXEL_MASK = (int64_t(1)<<VOXEL_BITS)-1;
+
+VoxelGrid::VoxelGrid(double _res) : res(_res) {
+  CHECK(res>0., "voxel size needs to be positive");
+  rehash(1024);
+}
+
+void VoxelGrid::clear() {
+  cells.clear();
+  table = UINT_MAX;
+  stamp = 0;
+}
+
+uint64_t VoxelGrid::keyOf(double x, double y, double z) const {
+  int64_t i = (int64_t)std::floor(x/res) + VOXEL_OFFSET;
+  int64_t j = (int64_t)std::floor(y/res) + VOXEL_OFFSET;
+  int64_t k = (int64_t)std::floor(z/res) + VOXEL_OFFSET;
+  CHECK((i&~VOXEL_MASK)==0 && (j&~VOXEL_MASK)==0 && (k&~VOXEL_MASK)==0, "point (" <<x <<' ' <<y <<' ' <<z <<") is out of the voxel grid range");
+  return uint64_t(i) | (uint64_t(j)<<VOXEL_BITS) | (uint64_t(k)<<(2*VOXEL_BITS));
+}
+
+uint VoxelGrid::slotOf(uint64_t key) const {
+  //Fibonacci hashing into the power-of-2 table, then linear probing
+  uint mask = table.N-1;
+  uint s = uint((key*0x9E3779B97F4A7C15ull)>>32) & mask;
+  for(;;) {
+    uint c = table.p[s];
+    if(c==UINT_MAX || cells[c].key==key) return s;
+    s = (s+1)&mask;
+  }
+}
+
+void VoxelGrid::rehash(uint tableSize) {
+  table.resize(tableSize);
+  table = UINT_MAX;
+  for(uint c=0; c<cells.size(); c++) table.p[slotOf(cells[c].key)] = c;
+}
+
+void VoxelGrid::reserve(uint n) {
+  cells.reserve(n);
+  uint tableSize = table.N;
+  while(tableSize<2*n) tableSize *= 2;
+  if(tableSize>table.N) rehash(tableSize);
+}
+
+void VoxelGrid::insertPoint(double x, double y, double z) {
+  if(std::isnan(x) || std::isnan(y) || std::isnan(z)) return;
+  uint64_t key = keyOf(x, y, z);
+  uint s = slotOf(key);
+  uint c = table.p[s];
+  if(c==UINT_MAX) {
+    c = cells.size();
+    table.p[s] = c;
+    cells.push_back({key, {0., 0., 0.}, 0, 0});
+    if(2*cells.size() > table.N) rehash(2*table.N); //keep the load factor below 1/2
+  }
+  Cell& cell = cells[c];
+  cell.sum[0] += x;  cell.sum[1] += y;  cell.sum[2] += z;
+  cell.count++;
+  cell.stamp = stamp;
+}
+
+void VoxelGrid::insert(const arr& pts) {
+  CHECK(!(pts.N%3), "points need to be 3D");
+  stamp++;
+  for(uint i=0; i<pts.N; i+=3) insertPoint(pts.p[i], pts.p[i+1], pts.p[i+2]);
+}
+
+void VoxelGrid::insert(const floatA& pts) {
+  CHECK(!(pts.N%3), "points need to be 3D");
+  stamp++;
+  for(uint i=0; i<pts.N; i+=3) insertPoint(pts.p[i], pts.p[i+1], pts.p[i+2]);
+}
+
+void VoxelGrid::insert(const Vector& x) {
+  stamp++;
+  insertPoint(x.x, x.y, x.z);
+}
+
+int VoxelGrid::find(const Vector& x) const {
+  uint c = table.p[slotOf(keyOf(x.x, x.y, x.z))];
+  if(c==UINT_MAX) return -1;
+  return c;
+}
+
+uint VoxelGrid::count(const Vector& x) const {
+  int c = find(x);
+  if(c<0) return 0;
+  return cells[c].count;
+}
+
+template<class T> void voxelCentroids(Array<T>& C, const std::vector<VoxelGrid::Cell>& cells, uint minPoints, uint stamp) {
+  uint m=0;
+  for(const VoxelGrid::Cell& c:cells) if(c.count>=minPoints && c.stamp>=stamp) m++;
+  C.resize(m, 3);
+  T* x=C.p;
+  for(const VoxelGrid::Cell& c:cells) if(c.count>=minPoints && c.stamp>=stamp) {
+      double w = 1./c.count;
+      *(x++) = w*c.sum[0];  *(x++) = w*c.sum[1];  *(x++) = w*c.sum[2];
+    }
+}
+
+void VoxelGrid::getCentroids(arr& C, uint minPoints) const { voxelCentroids(C, cells, minPoints, 0); }
+
+void VoxelGrid::getCentroids(floatA& C, uint minPoints) const { voxelCentroids(C, cells, minPoints, 0); }
+
+void VoxelGrid::getRecent(arr& C, uint minPoints) const { voxelCentroids(C, cells, minPoints, stamp); }
+
+void VoxelGrid::getCenters(arr& C, uint minPoints) const {
+  uint m=0;
+  for(const Cell& c:cells) if(c.count>=minPoints) m++;
+  C.resize(m, 3);
+  double* x=C.p;
+  for(const Cell& c:cells) if(c.count>=minPoints) {
+      for(uint d=0; d<3; d++) *(x++) = res*(double(int64_t((c.key>>(d*VOXEL_BITS))&VOXEL_MASK) - VOXEL_OFFSET) + .5);
+    }
+}
+
+//===========================================================================
+
+void voxelFilter(arr& out, const arr& pts, double res, uint minPoints) {
+  VoxelGrid grid(res);
+  grid.reserve(pts.N/3);
+  grid.insert(pts);
+  grid.getCentroids(out, minPoints);
+}
+
+void voxelFilter(floatA& out, const floatA& pts, double res, uint minPoints) {
+  VoxelGrid grid(res);
+  grid.reserve(pts.N/3);
+  grid.insert(pts);
+  grid.getCentroids(out, minPoints);
+}
+
+} //namespace rai
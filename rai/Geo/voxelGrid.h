@@ -0,0 +1,63 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "geo.h"
+
+namespace rai {
+
+//===========================================================================
+
+/// a sparse voxel grid (spatial hash) over 3D points: each occupied voxel accumulates the sum and count of the points
+/// inserted into it, so that centroids, occupancy and min-point thresholds can be queried. Insertion is incremental
+/// (e.g. across frames) and linear in the number of points; the open-addressing table and cell buffers are kept
+/// across clear(), so that repeated use does not allocate.
+struct VoxelGrid {
+  struct Cell {
+    uint64_t key;   ///< packed integer voxel coordinates
+    double sum[3];  ///< sum of the inserted points
+    uint count;     ///< number of inserted points
+    uint stamp;     ///< number of the insert() call that last touched the voxel
+  };
+
+  double res;         ///< voxel side length
+  std::vector<Cell> cells; ///< occupied voxels, in order of first insertion
+  uintA table;        ///< open-addressing hash table of indices into cells (UINT_MAX: empty)
+  uint stamp=0;
+
+  VoxelGrid(double res);
+
+  void clear();                                 ///< remove all voxels (keeps memory)
+  void reserve(uint n);                         ///< prepare the table for n occupied voxels
+  void insert(const arr& pts);                  ///< add (n,3) points, or any array with N%3==0; NaN points are skipped
+  void insert(const floatA& pts);
+  void insert(const Vector& x);
+
+  uint size() const { return cells.size(); }     ///< number of occupied voxels
+  int find(const Vector& x) const;              ///< index into cells of the voxel containing x, or -1
+  uint count(const Vector& x) const;            ///< number of points in the voxel containing x
+  bool isOccupied(const Vector& x, uint minPoints=1) const { return count(x)>=minPoints; }
+
+  void getCentroids(arr& C, uint minPoints=1) const;   ///< (m,3) centroids of all voxels with at least minPoints points
+  void getCentroids(floatA& C, uint minPoints=1) const;
+  void getCenters(arr& C, uint minPoints=1) const;     ///< (m,3) centers of all voxels with at least minPoints points
+  void getRecent(arr& C, uint minPoints=1) const;      ///< centroids of the voxels touched by the last insert()
+
+private:
+  uint64_t keyOf(double x, double y, double z) const;
+  uint slotOf(uint64_t key) const;
+  void insertPoint(double x, double y, double z);
+  void rehash(uint tableSize);
+};
+
+/// voxel-grid downsampling: replace all points by the centroids of their voxels (with at least minPoints points)
+void voxelFilter(arr& out, const arr& pts, double res, uint minPoints=1);
+void voxelFilter(floatA& out, const floatA& pts, double res, uint minPoints=1);
+
+} //namespace rai
@@ -41,6 +41,8 @@ OpenGLDrawOptions& GLDrawer::glDrawOptions(OpenGL& gl){ return gl.drawOptions; }
 
 Singleton<SingleGLAccess> singleGLAccess;
 
+static bool glutIsInitialized=false; //glut is only used for text; it is not initialized in headless mode
+
 //===========================================================================
 
 #ifdef RAI_FREEGLUT
@@ -63,6 +65,7 @@ class FreeglutSpinner : Thread {
     int argc=1;
     char* argv[1]= {(char*)"x"};
     glutInit(&argc, argv);
+    glutIsInitialized=true;
   }
   ~FreeglutSpinner() {
 //    uint i=0;  for(OpenGL* gl:glwins){ if(gl) delGL(i, gl); i++; }
@@ -270,13 +273,22 @@ struct GlfwSpinner : Thread {
     if(rai::getDisableGui()){ HALT("you must not be here with -disableGui"); }
 
     glfwSetErrorCallback(error_callback);
+#if GLFW_VERSION_MAJOR*100+GLFW_VERSION_MINOR >= 304
+    bool headless = !getenv("DISPLAY") && !getenv("WAYLAND_DISPLAY");
+    if(headless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL); //no window system: only offscreen windows, with OSMesa or EGL contexts
+#else
+    bool headless = false;
+#endif
     if(!glfwInit()) exit(EXIT_FAILURE);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
 
-    int argc=1;
-    char* argv[1]= {(char*)"x"};
-    glutInit(&argc, argv);
+    if(!headless) { //glut needs a display (only used for text rendering)
+      int argc=1;
+      char* argv[1]= {(char*)"x"};
+      glutInit(&argc, argv);
+      glutIsInitialized=true;
+    }
 
     threadLoop(true);
   }
@@ -411,6 +423,12 @@ void OpenGL::openWindow() {
 //      glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
       glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
 //      glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+#if GLFW_VERSION_MAJOR*100+GLFW_VERSION_MINOR >= 304
+      if(glfwGetPlatform()==GLFW_PLATFORM_NULL) {
+        if(rai::getParameter<rai::String>("OpenGL/headlessContext", "osmesa")=="egl") glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        else glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+      }
+#endif
     } else {
       glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
     }
@@ -708,7 +726,7 @@ void glPushLightOff() { glGetBooleanv(GL_LIGHTING, &glLightIsOn); glDisable(GL_L
 void glPopLight() { if(glLightIsOn) glEnable(GL_LIGHTING); }
 
 void glDrawText(const char* txt, float x, float y, float z, bool largeFont) {
-  if(!txt) return;
+  if(!txt || !glutIsInitialized) return;
   glDisable(GL_DEPTH_TEST);
   glPushLightOff();
   glRasterPos3f(x, y, z);
@@ -867,7 +885,40 @@ void glDrawBox(float x, float y, float z, bool linesOnly) {
   }
 }
 
+//-- unit primitives are compiled once per context into display lists and then only replayed (scaled) for each instance
+
+static thread_local OpenGL* drawingGL=nullptr; ///< the OpenGL currently within Draw (its context is current)
+enum GLPrimitive { GLP_axis=0, GLP_sphere, GLP_disk, GLP_diamond, GLP_count };
+static void glDrawPrimitive(GLPrimitive p);
+
+static bool glCallPrimitive(GLPrimitive p) {
+  if(!drawingGL) return false;
+  GLint mode;
+  glGetIntegerv(GL_RENDER_MODE, &mode);
+  if(mode!=GL_RENDER) return false;
+  if(!drawingGL->primitiveLists) {
+    uint base = glGenLists(GLP_count);
+    if(!base) return false;
+    drawingGL->primitiveLists = base;
+    for(uint i=0; i<GLP_count; i++) {
+      glNewList(base+i, GL_COMPILE);
+      glDrawPrimitive(GLPrimitive(i));
+      glEndList();
+    }
+  }
+  glCallList(drawingGL->primitiveLists+p);
+  return true;
+}
+
 void glDrawDiamond(float x, float y, float z) {
+  glPushMatrix();
+  glScalef(x, y, z);
+  if(!glCallPrimitive(GLP_diamond)) glDrawPrimitive(GLP_diamond);
+  glPopMatrix();
+}
+
+static void glDrawUnitDiamond() {
+  float x=1., y=1., z=1.;
 //  glDisable(GL_CULL_FACE);
   glBegin(GL_TRIANGLE_FAN);
   glVertex3f(.0, .0, z);
@@ -896,9 +947,14 @@ void glDrawDiamond(float x, float y, float z, float dx, float dy, float dz) {
 }
 
 void glDrawAxis(double scale) {
-//    glDisable(GL_CULL_FACE);
   if(scale>=0) glPushMatrix();
   if(scale>=0) glScalef(scale, scale, scale);
+  if(!glCallPrimitive(GLP_axis)) glDrawPrimitive(GLP_axis);
+  if(scale>=0) glPopMatrix();
+}
+
+static void glDrawUnitAxis() {
+//    glDisable(GL_CULL_FACE);
   GLUquadric* style=gluNewQuadric();
   glBegin(GL_LINES);
   glVertex3f(0, 0, 0);
@@ -908,7 +964,6 @@ void glDrawAxis(double scale) {
   glRotatef(90, 0, 1, 0);
   gluCylinder(style, .08, 0, .2, 20, 1);
   gluDeleteQuadric(style);
-  if(scale>=0) glPopMatrix();
 //    glEnable(GL_CULL_FACE);
 }
 
@@ -983,9 +1038,10 @@ void glDrawCamera(const rai::Camera& cam) {
 }
 
 void glDrawDisk(float radius) {
-  GLUquadric* style=gluNewQuadric();
-  gluDisk(style, 0, radius, 10, 1);
-  gluDeleteQuadric(style);
+  glPushMatrix();
+  glScalef(radius, radius, radius);
+  if(!glCallPrimitive(GLP_disk)) glDrawPrimitive(GLP_disk);
+  glPopMatrix();
 }
 
 void glDrawProxy(const arr& p1, const arr& p2, double diskSize, int colorCode, const arr& norm, double _rad1, double _rad2) {
@@ -1029,9 +1085,22 @@ void glDrawProxy(const arr& p1, const arr& p2, double diskSize, int colorCode, c
 }
 
 void glDrawSphere(float radius) {
-  GLUquadric* style=gluNewQuadric();
-  gluSphere(style, radius, 10, 10); // last two value for detail
-  gluDeleteQuadric(style);
+  glPushMatrix();
+  glScalef(radius, radius, radius);
+  if(!glCallPrimitive(GLP_sphere)) glDrawPrimitive(GLP_sphere);
+  glPopMatrix();
+}
+
+static void glDrawPrimitive(GLPrimitive p) {
+  GLUquadric* style=nullptr;
+  switch(p) {
+    case GLP_axis: glDrawUnitAxis(); break;
+    case GLP_sphere: style=gluNewQuadric(); gluSphere(style, 1., 10, 10); break; // last two value for detail
+    case GLP_disk: style=gluNewQuadric(); gluDisk(style, 0, 1., 10, 1); break;
+    case GLP_diamond: glDrawUnitDiamond(); break;
+    default: NIY;
+  }
+  if(style) gluDeleteQuadric(style);
 }
 
 void glDrawCylinder(float radius, float length, bool closed) {
@@ -1716,6 +1785,11 @@ void OpenGL::Draw(int w, int h, rai::Camera* cam, bool callerHasAlreadyLocked) {
     dataLock.lock(RAI_HERE); //now accessing user data
   }
 
+  static bool glewInitialized = (glewInit(), true); //buffer objects (Mesh::glDraw) need the extension entry points
+  (void)glewInitialized;
+  OpenGL* drawingGLBefore = drawingGL;
+  drawingGL = this;
+
   //clear bufferer
   GLint viewport[4] = {0, 0, w, h};
   glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
@@ -1737,6 +1811,7 @@ void OpenGL::Draw(int w, int h, rai::Camera* cam, bool callerHasAlreadyLocked) {
   glEnable(GL_DEPTH_TEST);  glDepthFunc(GL_LESS);
   glEnable(GL_BLEND);  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   glEnable(GL_CULL_FACE);  glFrontFace(GL_CCW);
+  glEnable(GL_NORMALIZE); //primitives are scaled instances of unit display lists
   glShadeModel(GL_FLAT);  //glShadeModel(GL_SMOOTH);
 
   if(drawOptions.pclPointSize>0.) glPointSize(drawOptions.pclPointSize);
@@ -1864,11 +1939,13 @@ void OpenGL::Draw(int w, int h, rai::Camera* cam, bool callerHasAlreadyLocked) {
 
   //cout <<"UNLOCK draw" <<endl;
 
-  captureImage.resize(h, w, 3);
-  glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, captureImage.p);
+  if(captureInDraw) {
+    captureImage.resize(h, w, 3);
+    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, captureImage.p);
 
-  captureDepth.resize(h, w);
-  glReadPixels(0, 0, w, h, GL_DEPTH_COMPONENT, GL_FLOAT, captureDepth.p);
+    captureDepth.resize(h, w);
+    glReadPixels(0, 0, w, h, GL_DEPTH_COMPONENT, GL_FLOAT, captureDepth.p);
+  }
 
   //check matrix stack
   GLint s;
@@ -1878,6 +1955,17 @@ void OpenGL::Draw(int w, int h, rai::Camera* cam, bool callerHasAlreadyLocked) {
   }
   //CHECK_LE(s, 1, "OpenGL matrix stack has not depth 1 (pushs>pops)");
 
+  //release buffers of meshes that were not drawn for a while (e.g. deleted)
+  drawCount++;
+  for(auto it=meshBuffers.begin(); it!=meshBuffers.end();) {
+    if(drawCount - it->second.lastUsed > 100) {
+      glDeleteBuffers(1, &it->second.vbo);
+      glDeleteBuffers(1, &it->second.ibo);
+      it = meshBuffers.erase(it);
+    } else it++;
+  }
+  drawingGL = drawingGLBefore;
+
   if(!callerHasAlreadyLocked) {
     //now de-accessing user data
     dataLock.unlock();
@@ -2573,6 +2661,102 @@ void OpenGL::renderInBack(int w, int h, bool fromWithinCallback) {
   endNonThreadedDraw(fromWithinCallback);
 }
 
+void OpenGL::renderToTarget(uint target, int w, int h) {
+#ifdef RAI_GL
+  CHECK_EQ(w%4, 0, "should be devidable by 4!!");
+  if(renderTargets.N<=target) renderTargets.resizeCopy(target+1);
+  GLRenderTarget& T = renderTargets(target);
+
+  if(!T.fbo || T.width!=w || T.height!=h) { //(re)create framebuffer and pixel buffers
+    glewInit();
+    if(T.fbo) {
+      glDeleteFramebuffers(1, &T.fbo);
+      glDeleteRenderbuffers(1, &T.rboColor);
+      glDeleteRenderbuffers(1, &T.rboDepth);
+      glDeleteBuffers(2, T.pboColor);
+      glDeleteBuffers(2, T.pboDepth);
+    }
+    T.width=w; T.height=h;
+    T.issued=T.collected=0;
+    glGenRenderbuffers(1, &T.rboColor);
+    glBindRenderbuffer(GL_RENDERBUFFER, T.rboColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+    glGenRenderbuffers(1, &T.rboDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, T.rboDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glGenFramebuffers(1, &T.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, T.fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, T.rboColor);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,  GL_RENDERBUFFER, T.rboDepth);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if(status != GL_FRAMEBUFFER_COMPLETE) HALT("couldn't create framebuffer, status=" <<status);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(2, T.pboColor);
+    glGenBuffers(2, T.pboDepth);
+    for(uint i=0; i<2; i++) {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, T.pboColor[i]);
+      glBufferData(GL_PIXEL_PACK_BUFFER, w*h*3, nullptr, GL_STREAM_READ);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, T.pboDepth[i]);
+      glBufferData(GL_PIXEL_PACK_BUFFER, w*h*sizeof(float), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
+  if(T.issued-T.collected>=2) T.collected++; //both pixel buffers are pending: drop the oldest readback
+
+  //-- draw
+  glBindFramebuffer(GL_FRAMEBUFFER, T.fbo);
+  captureInDraw=false;
+  Draw(w, h, nullptr, true);
+  captureInDraw=true;
+
+  //-- initiate readback: with a bound pixel pack buffer, glReadPixels returns immediately
+  uint i = T.issued%2;
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, T.pboColor[i]);
+  glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, T.pboDepth[i]);
+  glReadPixels(0, 0, w, h, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  T.issued++;
+#else
+  NICO
+#endif
+}
+
+bool OpenGL::collectTarget(uint target, byteA& image, floatA& depth, bool latest) {
+#ifdef RAI_GL
+  if(renderTargets.N<=target) return false;
+  GLRenderTarget& T = renderTargets(target);
+  if(T.issued==T.collected) return false;
+  if(latest) T.collected = T.issued-1;
+
+  uint i = T.collected%2;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, T.pboColor[i]);
+  void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  CHECK(data, "could not map pixel buffer");
+  image.resize(T.height, T.width, 3);
+  memmove(image.p, data, image.N);
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+  if(!!depth) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, T.pboDepth[i]);
+    data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    CHECK(data, "could not map pixel buffer");
+    depth.resize(T.height, T.width);
+    memmove(depth.p, data, depth.N*sizeof(float));
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  T.collected++;
+  return true;
+#else
+  NICO
+#endif
+}
+
 //===========================================================================
 //
 // GUI implementation
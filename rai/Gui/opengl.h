@@ -12,6 +12,7 @@
 #include "../Core/thread.h"
 #include "../Geo/geo.h"
 #include <functional>
+#include <map>
 
 #ifdef RAI_FLTK
 #  include <FL/glut.H>
@@ -123,6 +124,8 @@ struct OpenGL {
   struct GLEvent    { int button, key, x, y; float dx, dy; void set(int b, int k, int _x, int _y, float _dx, float _dy) { button=b; key=k; x=_x; y=_y; dx=_dx; dy=_dy; } };
   struct GLSelect   { int name; double dmin, dmax, x, y, z; };
   struct GLView     { double le, ri, bo, to;  rai::Array<GLDrawer*> drawers;  rai::Camera camera;  byteA* img;  rai::String text;  GLView() { img=nullptr; le=bo=0.; ri=to=1.; } };
+  struct GLBuffer   { uint vbo=0, ibo=0; uint64_t fingerprint=0, contentHash=0; uint lastUsed=0; size_t offsetNormals=0, offsetColors=0; };
+  struct GLRenderTarget { uint fbo=0, rboColor=0, rboDepth=0, pboColor[2]={0, 0}, pboDepth[2]={0, 0}; int width=0, height=0; uint issued=0, collected=0; };
 
   /// @name data fields
   rai::Array<GLView> views;            ///< list of subviews
@@ -160,6 +163,11 @@ struct OpenGL {
   uint fboId;
   uint rboColor;
   uint rboDepth;
+  rai::Array<GLRenderTarget> renderTargets; ///< persistent offscreen framebuffers with double-buffered pixel buffer objects, see renderToTarget
+  bool captureInDraw=true; ///< whether Draw reads back captureImage and captureDepth (synchronously)
+  std::map<uint64_t, GLBuffer> meshBuffers; ///< GPU-resident copies of large meshes (by Mesh::glId), released when not drawn for a while
+  uint primitiveLists=0; ///< display lists of unit primitives (axis, sphere, disk, diamond), replayed for each marker or proxy
+  uint drawCount=0;
   Signaler isUpdating;
   Signaler watching;
   OpenGLDrawOptions drawOptions;
@@ -200,6 +208,10 @@ struct OpenGL {
   void Select(bool callerHasAlreadyLocked=false);
   void renderInBack(int w=-1, int h=-1, bool fromWithinCallback=false);
 
+  /// @name offscreen rendering into persistent framebuffers with asynchronous readback (caller has to beginNonThreadedDraw)
+  void renderToTarget(uint target, int w, int h); ///< draws into the target's framebuffer and only initiates the readback into a pixel buffer object
+  bool collectTarget(uint target, byteA& image, floatA& depth, bool latest=false); ///< copies out the oldest pending readback of the target (blocks only if not yet done); false if none is pending; latest: drops older pending readbacks and copies out the one initiated last
+
   /// @name showing, updating, and watching
   int update(const char* text=nullptr, bool nonThreaded=false);
   int watch(const char* text=nullptr);
@@ -36,6 +36,7 @@
 #include "../Core/util.ipp"
 
 #include <iomanip>
+#include <map>
 
 #ifdef RAI_GL
 #  include <GL/gl.h>
@@ -105,7 +106,7 @@ void KOMO::clone(const KOMO& komo, bool deepCopyFeatures){
   tau = komo.tau;
   k_order = komo.k_order;
 
-  if(komo.fcl) fcl=komo.fcl;
+  if(komo.fcl) { fcl=komo.fcl; fclCopies.clear(); }
   if(komo.swift) swift=komo.swift;
 
   //directly copy pathConfig instead of recreating it (including switches)
@@ -167,6 +168,8 @@ void KOMO::clearObjectives() {
 
 void KOMO::_addObjective(const std::shared_ptr<Objective>& ob, const intA& timeSlices){
   objectives.append(ob);
+  runSolver.reset();
+  runProblem.reset();
 
   CHECK_EQ(timeSlices.nd, 2, "");
   for(uint c=0;c<timeSlices.d0;c++){
@@ -220,6 +223,8 @@ void KOMO::addSwitch(const arr& times, bool before, const ptr<KinematicSwitch>&
   sw->setTimeOfApplication(times, before, stepsPerPhase, T);
   applySwitch(*sw); //apply immediately
   switches.append(sw); //only to report, not apply in retrospect
+  runSolver.reset();
+  runProblem.reset();
 }
 
 ptr<KinematicSwitch> KOMO::addSwitch(const arr& times, bool before, bool stable,
@@ -753,10 +758,16 @@ void KOMO::updateAndShiftPrefix(const Configuration& C){
 
 void KOMO::reset() {
   dual.clear();
+  runSolver.reset();
+  runProblem.reset();
   featureValues.clear();
   featureJacobians.clear();
   featureTypes.clear();
-  timeTotal=timeCollisions=timeKinematics=timeNewton=timeFeatures=0.;
+  timeTotal=timeCollisions=timeKinematics=timeNewton=timeFeatures=timeFeaturesWall=timeCollisionsWall=0.;
+  timeFeaturesPerThread.clear();
+  coherentX.clear();
+  coherentPairs.clear();
+  fclCopies.clear();
 }
 
 //default - transcription as sparse, but non-factored NLP
@@ -766,6 +777,18 @@ struct Conv_KOMO_SparseNonfactored : MathematicalProgram {
 
   arr quadraticPotentialLinear, quadraticPotentialHessian;
 
+  //-- parallel feature evaluation (opt.parallelFeatures>1)
+  shared_ptr<ThreadPool> pool;
+  uintA rowStart;  ///< first row of each grounded objective in phi (size objs.N+1)
+  std::vector<std::mutex> featureMutexes; ///< features may change members while evaluating (order in phi_finiteDifferenceReduce, coll in F_PairCollision)...
+  intA featureMutexOf;                    ///< ...so grounded objectives sharing one Feature instance lock its mutex (-1: none needed)
+
+  //-- sparse Jacobian pattern, fixed after the first evaluation; later evaluations only write values into it
+  intA Jpattern;       ///< (row,col) of all non-zeros of J (memory order as SparseMatrix::elems)
+  uintA JpatternStart; ///< for each grounded objective the index of its first non-zero in Jpattern (size objs.N+1)
+
+  rai::ArrayArena arena; ///< pool for the temporary arrays of evaluate (opt.arrayArena)
+
   Conv_KOMO_SparseNonfactored(KOMO& _komo, bool sparse=true);
 
   virtual arr getInitializationSample(const arr& previousOptima= {});
@@ -773,6 +796,10 @@ struct Conv_KOMO_SparseNonfactored : MathematicalProgram {
   virtual void getFHessian(arr& H, const arr& x);
 
   virtual void report(ostream& os, int verbose);
+
+  void evaluateParallel(arr& phi, arr& J, bool reusePattern, std::vector<arr>& YJ, boolA& written);
+  bool setJacobianValues(arr& J, const arr& yJ, uint i, uint M);
+  void addSparseJacobianBlock(arr& J, arr& yJ, uint i, uint M, bool written, bool& reusePattern, uintA& start);
 };
 
 //this treats EACH BRANCH and dof as its own variable
@@ -899,6 +926,16 @@ void KOMO::run(OptOptions options) {
   if(solver==rai::KS_none) {
     HALT("you need to choose a KOMO solver");
 
+  } else if(opt.reuseSolver && (solver==rai::KS_dense || solver==rai::KS_sparse)) {
+    if(!runSolver || runProblem->getDimension()!=x.N) {
+      runProblem = make_shared<Conv_KOMO_SparseNonfactored>(*this, solver==rai::KS_sparse);
+      runSolver = make_shared<OptConstrained>(x, dual, runProblem, options, logFile);
+    } else {
+      runSolver->reinit(options);
+    }
+    runSolver->run();
+    timeNewton += runSolver->newton.timeNewton;
+
   } else if(solver==rai::KS_dense || solver==rai::KS_sparse) {
     Conv_KOMO_SparseNonfactored P(*this, solver==rai::KS_sparse);
     OptConstrained _opt(x, dual, P.ptr(), options, logFile);
@@ -948,6 +985,8 @@ void KOMO::run(OptOptions options) {
   if(opt.verbose>0) {
     cout <<"** optimization time:" <<timeTotal
          <<" (kin:" <<timeKinematics <<" coll:" <<timeCollisions <<" feat:" <<timeFeatures <<" newton: " <<timeNewton <<")"
+         <<" feat-wall:" <<timeFeaturesWall <<(timeFeaturesPerThread.N?STRING(" feat-threads:" <<timeFeaturesPerThread):rai::String())
+         <<" coll-wall:" <<timeCollisionsWall <<(collisionPool?STRING(" coll-cpu/wall:" <<timeCollisions/timeCollisionsWall):rai::String())
          <<" setJointStateCount:" <<Configuration::setJointStateCount
         <<"\n   sos:" <<sos <<" ineq:" <<ineq <<" eq:" <<eq <<endl;
   }
@@ -1189,7 +1228,7 @@ void KOMO::setupPathConfig() {
     CHECK(!fcl, "");
     CHECK(!swift, "");
     if(!opt.useFCL) swift = C.swift();
-    else fcl = C.fcl();
+    else { fcl = C.fcl(); fclCopies.clear(); }
   }
 
   for(uint s=0;s<k_order+T;s++) {
@@ -1282,22 +1321,93 @@ void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
 
   if(computeCollisions) {
     timeCollisions -= rai::cpuTime();
+    timeCollisionsWall -= rai::realTime();
     pathConfig.proxies.clear();
-    arr X;
-    uintA collisionPairs;
-    for(uint s=k_order;s<timeSlices.d0;s++){
-      X = pathConfig.getFrameState(timeSlices[s]);
-      if(!opt.useFCL){
-        collisionPairs = swift->step(X);
-      }else{
-        fcl->step(X);
-        collisionPairs = fcl->collisions;
+    if(opt.useFCL && coherentX.N!=timeSlices.d0){
+      coherentX.resize(timeSlices.d0);
+      coherentPairs.resize(timeSlices.d0);
+    }
+    if(opt.useFCL && opt.parallelCollisions>1){
+      set_x_parallelCollisions();
+    }else{
+      arr X;
+      uintA collisionPairs;
+      for(uint s=k_order;s<timeSlices.d0;s++){
+        X = pathConfig.getFrameState(timeSlices[s]);
+        if(!opt.useFCL){
+          collisionPairs = swift->step(X);
+        }else{
+          queryCollisions(*fcl, s, collisionPairs);
+        }
+        collisionPairs += timeSlices.d1 * s; //fcl returns frame IDs related to 'world' -> map them into frameIDs within that time slice
+        pathConfig.addProxies(collisionPairs);
       }
-      collisionPairs += timeSlices.d1 * s; //fcl returns frame IDs related to 'world' -> map them into frameIDs within that time slice
-      pathConfig.addProxies(collisionPairs);
     }
     pathConfig._state_proxies_isGood=true;
     timeCollisions += rai::cpuTime();
+    timeCollisionsWall += rai::realTime();
+  }
+}
+
+void KOMO::set_x_parallelCollisions() {
+  //-- each chunk of consecutive time slices is queried with its own broadphase copy (which profits from little motion between slices)
+  uint nChunks = opt.parallelCollisions;
+  if(!collisionPool || collisionPool->size()!=nChunks) collisionPool = make_shared<ThreadPool>(nChunks);
+  if(fclCopies.N!=nChunks || fclCopiesOf!=fcl.get()) { //(re)create the copies if fcl was replaced
+    fclCopies.resize(nChunks);
+    for(auto& f:fclCopies) f = make_shared<rai::FclInterface>(*fcl);
+    fclCopiesOf = fcl.get();
+  }
+
+  //-- forward kinematics first: queries then only read frame poses
+  pathConfig.ensure_X();
+
+  uint S = timeSlices.d0-k_order;
+  uintAA collisionPairs(timeSlices.d0);
+  collisionPool->parallelFor(nChunks, [this, S, nChunks, &collisionPairs](uint c, uint) {
+    rai::FclInterface& F = *fclCopies(c);
+    for(uint s=k_order+(c*S)/nChunks; s<k_order+((c+1)*S)/nChunks; s++) {
+      queryCollisions(F, s, collisionPairs(s));
+      collisionPairs(s) += timeSlices.d1 * s;
+    }
+  });
+
+  //-- merge proxies in slice order
+  for(uint s=k_order;s<timeSlices.d0;s++) pathConfig.addProxies(collisionPairs(s));
+}
+
+void KOMO::queryCollisions(rai::FclInterface& F, uint s, uintA& pairs) {
+  arr X = pathConfig.getFrameState(timeSlices[s]);
+  arr& X_last = coherentX(s);
+
+  if(opt.coherentCollisions<=0. || X_last.N!=X.N) {
+    F.step(X);
+    pairs = F.collisions;
+    if(opt.coherentCollisions>0.) { X_last = X;  coherentPairs(s) = pairs; }
+    return;
+  }
+
+  //-- which objects moved since their last query in this slice?
+  boolA moved(X.d0);
+  uint nMoved=0;
+  for(uint i=0; i<X.d0; i++) {
+    moved(i) = (maxDiff(X[i], X_last[i]) > opt.coherentCollisions);
+    if(moved(i)) nMoved++;
+  }
+
+  //-- keep last pairs among non-moved objects; re-query only the moved ones
+  uintA& last = coherentPairs(s);
+  if(nMoved) {
+    F.step(X, moved);
+    pairs.resize(0, 2);
+    for(uint k=0; k<last.d0; k++) if(!moved(last(k, 0)) && !moved(last(k, 1))) pairs.append(last[k]);
+    pairs.append(F.collisions);
+    pairs.reshape(pairs.N/2, 2);
+    last = pairs;
+    //only moved objects get a new reference pose -- otherwise slow drift would never trigger a query
+    for(uint i=0; i<X.d0; i++) if(moved(i)) X_last[i] = X[i];
+  } else {
+    pairs = last;
   }
 }
 
@@ -1524,6 +1634,8 @@ StringA KOMO::getCollisionPairs(double belowMargin){
 }
 
 void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
+  rai::ArrayArena::Scope useArena(komo.opt.arrayArena ? &arena : nullptr);
+
   //-- set the trajectory
   komo.set_x(x);
   if(sparse){
@@ -1533,9 +1645,17 @@ void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
   }
 
   phi.resize(featureTypes.N);
+  bool reusePattern = sparse && !!J && JpatternStart.N==komo.objs.N+1;
+  uintA start;
   if(!!J) {
     if(sparse) {
-      J.sparse().resize(phi.N, x.N, 0);
+      if(reusePattern){
+        J.sparse().resize(phi.N, x.N, Jpattern.d0);
+        J.sparse().elems = Jpattern;
+      } else {
+        J.sparse().resize(phi.N, x.N, 0);
+        start.resize(komo.objs.N+1);
+      }
     } else {
       J.resize(phi.N, x.N).setZero();
     }
@@ -1544,11 +1664,26 @@ void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
   komo.sos=komo.ineq=komo.eq=0.;
 
   komo.timeFeatures -= rai::cpuTime();
+  komo.timeFeaturesWall -= rai::realTime();
 
   uint M=0;
-  for(shared_ptr<GroundedObjective>& ob : komo.objs) {
+  if(pool) {
+    //-- parallel mode: each grounded objective writes its rows of phi (and J, if dense or the pattern is cached) concurrently
+    std::vector<arr> YJ;
+    boolA written;
+    evaluateParallel(phi, J, reusePattern, YJ, written);
+    M = rowStart.last();
+    //sparse Jacobian blocks that could not be written into the pattern are appended in order
+    if(!!J && sparse) for(uint i=0; i<komo.objs.N; i++) {
+      if(start.N) start(i) = J.N;
+      if(rowStart(i+1)==rowStart(i)) continue;
+      addSparseJacobianBlock(J, YJ[i], i, rowStart(i), written(i), reusePattern, start);
+    }
+  } else for(uint i=0; i<komo.objs.N; i++) {
+      shared_ptr<GroundedObjective>& ob = komo.objs.elem(i);
       //query the task map and check dimensionalities of returns
       arr y = ob->feat->eval(ob->frames);
+      if(start.N) start(i) = J.N;
 //      cout <<"EVAL '" <<ob->name() <<"' phi:" <<y <<endl <<y.J() <<endl<<endl;
       if(!y.N) continue;
       checkNan(y);
@@ -1576,9 +1711,7 @@ void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
 
       if(!!J) {
         if(sparse){
-          yJ.sparse().reshape(J.d0, J.d1);
-          yJ.sparse().colShift(M);
-          J += yJ;
+          addSparseJacobianBlock(J, yJ, i, M, reusePattern && setJacobianValues(J, yJ, i, M), reusePattern, start);
         }else{
           J.setMatrixBlock(yJ, M, 0);
         }
@@ -1589,8 +1722,14 @@ void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
   }
 
   komo.timeFeatures += rai::cpuTime();
+  komo.timeFeaturesWall += rai::realTime();
 
   CHECK_EQ(M, phi.N, "");
+  if(start.N) {
+    start.last() = J.N;
+    Jpattern = J.sparse().elems;
+    JpatternStart = start;
+  }
   komo.featureValues = phi;
   if(!!J) komo.featureJacobians.resize(1).scalar() = J;
 
@@ -1602,6 +1741,112 @@ void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
   }
 }
 
+bool Conv_KOMO_SparseNonfactored::setJacobianValues(arr& J, const arr& yJ, uint i, uint M) {
+  uint k0 = JpatternStart(i), n = JpatternStart(i+1)-k0;
+  const int* pattern = Jpattern.p+2*k0;
+  double* values = J.p+k0;
+  if(isSparseMatrix(yJ)) {
+    if(yJ.N!=n) return false;
+    const int* elems = yJ.sparse().elems.p;
+    for(uint k=0; k<2*n; k+=2) {
+      if(elems[k]+(int)M!=pattern[k] || elems[k+1]!=pattern[k+1]) return false;
+    }
+    memmove(values, yJ.p, n*yJ.sizeT);
+    return true;
+  }
+  //dense block: its pattern are the non-zeros in row-major order (as in SparseMatrix::setFromDense)
+  uint k=0;
+  for(uint r=0; r<yJ.d0; r++) for(uint c=0; c<yJ.d1; c++) {
+    double a = yJ.p[r*yJ.d1+c];
+    if(!a) continue;
+    if(k>=n || pattern[2*k]!=int(r+M) || pattern[2*k+1]!=int(c)) return false;
+    values[k++] = a;
+  }
+  return k==n;
+}
+
+void Conv_KOMO_SparseNonfactored::addSparseJacobianBlock(arr& J, arr& yJ, uint i, uint M, bool written, bool& reusePattern, uintA& start) {
+  if(reusePattern && !written) {
+    //the pattern changed (e.g. new collisions): keep the blocks before, append all following ones
+    reusePattern = false;
+    J.sparse().resizeCopy(J.d0, J.d1, JpatternStart(i));
+    start = JpatternStart;
+    start(i) = J.N;
+  }
+  if(!reusePattern) {
+    yJ.sparse().reshape(J.d0, J.d1);
+    yJ.sparse().colShift(M);
+    J += yJ;
+  }
+}
+
+void Conv_KOMO_SparseNonfactored::evaluateParallel(arr& phi, arr& J, bool reusePattern, std::vector<arr>& YJ, boolA& written) {
+  rai::Configuration& C = komo.pathConfig;
+
+  //-- resolve all lazy state of the configuration, so that feature evaluations only read it
+  C.ensure_indexedJoints();
+  C.ensure_X();
+  for(rai::Frame* f:C.frames) {
+    if(f->shape) { f->shape->mesh(); f->shape->sscCore(); }
+  }
+  pool->parallelFor(C.proxies.N, [&C](uint i, uint) {
+    rai::Proxy& p = C.proxies.elem(i);
+    if(!p.collision) p.calc_coll();
+  });
+
+  //-- one job per grounded objective; each writes only its own rows of phi and J
+  uint n = komo.objs.N;
+  YJ.resize(n);
+  written.resize(n).setZero();
+  arr cost = zeros(n);
+  if(komo.timeFeaturesPerThread.N!=pool->size()) komo.timeFeaturesPerThread = zeros(pool->size());
+  uint xDim = C.getJointStateDimension();
+  pool->parallelFor(n, [&](uint i, uint threadID) {
+    double time = -rai::realTime();
+    GroundedObjective* ob = komo.objs.elem(i).get();
+    arr y;
+    if(featureMutexOf(i)>=0) {
+      std::lock_guard<std::mutex> lock(featureMutexes[featureMutexOf(i)]);
+      y = ob->feat->eval(ob->frames);
+    } else {
+      y = ob->feat->eval(ob->frames);
+    }
+    uint M = rowStart(i);
+    CHECK_EQ(y.N, rowStart(i+1)-M, "feature dimension changed -- parallel evaluation needs fixed dimensions");
+    if(y.N) {
+      checkNan(y);
+      if(!!J) {
+        CHECK(y.jac, "Jacobian needed but missing");
+        CHECK_EQ(y.J().nd, 2, "");
+        CHECK_EQ(y.J().d0, y.N, "");
+        CHECK_EQ(y.J().d1, xDim, "");
+      }
+      if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
+
+      YJ[i] = y.J_reset();
+      phi.setVectorBlock(y, M);
+
+      if(ob->type==OT_sos) cost(i) = sumOfSqr(y);
+      else if(ob->type==OT_ineq) cost(i) = sumOfPos(y);
+      else if(ob->type==OT_eq) cost(i) = sumOfAbs(y);
+
+      if(!!J) {
+        if(!sparse) J.setMatrixBlock(YJ[i], M, 0);
+        else if(reusePattern) written(i) = setJacobianValues(J, YJ[i], i, M);
+      }
+    }
+    komo.timeFeaturesPerThread(threadID) += time + rai::realTime();
+  });
+
+  //-- sum costs in the serial order, so that they are bitwise identical to serial evaluation
+  for(uint i=0; i<n; i++) {
+    ObjectiveType type = komo.objs.elem(i)->type;
+    if(type==OT_sos) komo.sos += cost(i);
+    else if(type==OT_ineq) komo.ineq += cost(i);
+    else if(type==OT_eq) komo.eq += cost(i);
+  }
+}
+
 void Conv_KOMO_SparseNonfactored::getFHessian(arr& H, const arr& x) {
   if(quadraticPotentialLinear.N) {
     H = quadraticPotentialHessian;
@@ -1633,17 +1878,40 @@ Conv_KOMO_SparseNonfactored::Conv_KOMO_SparseNonfactored(KOMO& _komo, bool spars
 
   featureTypes.resize(M);
   komo.featureNames.clear();
+  rowStart.resize(komo.objs.N+1);
   M=0;
-  for(shared_ptr<GroundedObjective>& ob : komo.objs) {
+  for(uint k=0; k<komo.objs.N; k++) {
+    shared_ptr<GroundedObjective>& ob = komo.objs.elem(k);
+    rowStart(k) = M;
     uint m = ob->feat->dim(ob->frames);
     for(uint i=0; i<m; i++) featureTypes(M+i) = ob->type;
     for(uint j=0; j<m; j++) komo.featureNames.append(ob->feat->shortTag(komo.pathConfig));
     M += m;
   }
+  rowStart.last() = M;
   if(quadraticPotentialLinear.N) {
     featureTypes.append(OT_f);
   }
   komo.featureTypes = featureTypes;
+
+  //-- parallel evaluation: grounded objectives sharing a Feature instance (of any order) must not evaluate it concurrently
+  if(komo.opt.parallelFeatures>1) {
+    std::map<Feature*, uint> count;
+    for(shared_ptr<GroundedObjective>& ob : komo.objs) count[ob->feat.get()]++;
+    std::map<Feature*, int> mutexOf;
+    featureMutexOf.resize(komo.objs.N);
+    for(uint i=0; i<komo.objs.N; i++) {
+      Feature* f = komo.objs.elem(i)->feat.get();
+      featureMutexOf(i) = -1;
+      if(count[f]>1) {
+        auto it = mutexOf.find(f);
+        if(it==mutexOf.end()) it = mutexOf.emplace(f, mutexOf.size()).first;
+        featureMutexOf(i) = it->second;
+      }
+    }
+    featureMutexes = std::vector<std::mutex>(mutexOf.size());
+    pool = make_shared<ThreadPool>(komo.opt.parallelFeatures);
+  }
 }
 
 arr Conv_KOMO_SparseNonfactored::getInitializationSample(const arr& previousOptima) {
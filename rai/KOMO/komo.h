@@ -22,6 +22,7 @@
 namespace rai {
   struct FclInterface;
 }
+struct ThreadPool;
 
 //===========================================================================
 
@@ -38,6 +39,11 @@ namespace rai {
     RAI_PARAM("KOMO/", int, animateOptimization, 0)
     RAI_PARAM("KOMO/", bool, mimicStable, false)
     RAI_PARAM("KOMO/", bool, useFCL, true)
+    RAI_PARAM("KOMO/", int, parallelFeatures, 0) //number of threads to evaluate grounded objectives concurrently (<=1: serial)
+    RAI_PARAM("KOMO/", int, parallelCollisions, 0) //number of threads to query collisions of time slices concurrently (<=1: serial; FCL only)
+    RAI_PARAM("KOMO/", double, coherentCollisions, 0.) //>0: per slice, only re-query objects that moved more than this since their last query, and reuse all other pairs (FCL only)
+    RAI_PARAM("KOMO/", bool, reuseSolver, false) //keep the problem transcription and solver state across run() calls (KS_sparse/KS_dense), warm started from the last primal/dual solution
+    RAI_PARAM("KOMO/", bool, arrayArena, false) //opt-in: evaluate the transcribed problem with a pooled array allocator (reuses temporary array memory across evaluations)
   };
 }//namespace
 
@@ -60,10 +66,17 @@ struct KOMO : NonCopyable {
   bool computeCollisions;         ///< whether swift or fcl (collisions/proxies) is evaluated whenever new configurations are set (needed if features read proxy list)
   shared_ptr<rai::FclInterface> fcl;
   shared_ptr<SwiftInterface> swift;
+  rai::Array<shared_ptr<rai::FclInterface>> fclCopies; ///< one broadphase per chunk of time slices (parallelCollisions mode)
+  rai::FclInterface* fclCopiesOf=0; ///< the fcl that fclCopies were copied from
+  shared_ptr<ThreadPool> collisionPool;
+  arrA coherentX;                 ///< per time slice: frame poses at which each object was last queried (coherentCollisions mode)
+  uintAA coherentPairs;           ///< per time slice: collision pairs of the last query (coherentCollisions mode)
 
   //-- optimizer
   rai::KOMOsolver solver=rai::KS_sparse;
   arr x, dual;                 ///< the primal and dual solution
+  shared_ptr<MathematicalProgram> runProblem; ///< persistent transcription (opt.reuseSolver): keeps the sparse Jacobian pattern and evaluation lanes
+  shared_ptr<OptConstrained> runSolver;       ///< persistent solver (opt.reuseSolver): keeps the Lagrangian, Newton buffers and sparse symbolic analysis; dropped by reset()
 
   //-- options
   rai::KOMO_Options opt;
@@ -76,6 +89,9 @@ struct KOMO : NonCopyable {
   StringA featureNames;
   double timeTotal=0.;           ///< measured run time
   double timeCollisions=0., timeKinematics=0., timeNewton=0., timeFeatures=0.;
+  double timeFeaturesWall=0.;  ///< wall time of feature evaluation (timeFeatures is process cpu time, summed over threads)
+  double timeCollisionsWall=0.; ///< wall time of collision queries (timeCollisions is process cpu time; their ratio is the parallelism used, not a speedup over the serial query)
+  arr timeFeaturesPerThread;   ///< busy (wall) time of each thread in parallel feature evaluation
   ofstream* logFile=0;
 
   KOMO();
@@ -211,6 +227,8 @@ public:
   void retrospectApplySwitches();
   void retrospectChangeJointType(int startStep, int endStep, uint frameID, rai::JointType newJointType);
   void set_x(const arr& x, const uintA& selectedConfigurationsOnly=NoUintA);            ///< set the state trajectory of all configurations
+  void set_x_parallelCollisions();  ///< (called by set_x) query proxies of all time slices concurrently, merge them in slice order
+  void queryCollisions(rai::FclInterface& F, uint s, uintA& pairs); ///< (called by set_x) collision pairs of slice s (in world frame IDs), possibly reusing the last query of that slice
 
 
   //===========================================================================
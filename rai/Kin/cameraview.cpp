@@ -104,10 +104,49 @@ void rai::CameraView::computeImageAndDepth(byteA& image, floatA& depth) {
   // gl.update(nullptr, true);
   gl.renderInBack();
   image = gl.captureImage;
+  if(!!depth) depth = gl.captureDepth;
+  postProcess(image, depth, gl.camera);
+  done(__func__);
+}
+
+void rai::CameraView::computeImageAndDepthAll(Array<byteA>& images, Array<floatA>& depths, bool pipelined) {
+  updateCamera();
+  images.resize(sensors.N);
+  depths.resize(sensors.N);
+  rai::Camera cam = gl.camera;
+
+  gl.beginNonThreadedDraw();
+  {
+    auto _dataLock = gl.dataLock(RAI_HERE);
+    //-- render all sensors; each only initiates its readback
+    for(uint i=0; i<sensors.N; i++) {
+      Sensor& sen = sensors(i);
+      gl.camera = sen.cam;
+      gl.background = sen.backgroundImage;
+      gl.backgroundZoom = (double)sen.height/gl.background.d0;
+      gl.renderToTarget(i, sen.width, sen.height);
+    }
+    gl.camera = cam;
+
+    //-- collect: the previous call's readbacks, or (if not pipelined) the ones just initiated -- dropping a still pending one of an earlier pipelined call
+    for(uint i=0; i<sensors.N; i++) {
+      const OpenGL::GLRenderTarget& T = gl.renderTargets(i);
+      if(pipelined && T.issued-T.collected<2) { images(i).clear(); depths(i).clear(); continue; }
+      gl.collectTarget(i, images(i), depths(i), !pipelined);
+    }
+  }
+  gl.endNonThreadedDraw();
+
+  for(uint i=0; i<sensors.N; i++) if(images(i).N) postProcess(images(i), depths(i), sensors(i).cam);
+  done(__func__);
+}
+
+void rai::CameraView::postProcess(byteA& image, floatA& depth, const rai::Camera& cam) {
   flip_image(image);
   if(renderMode==seg && frameIDmap.N) {
-    byteA seg(image.d0*image.d1);
-    image.reshape(image.d0*image.d1, 3);
+    uint H=image.d0, W=image.d1;
+    byteA seg(H*W);
+    image.reshape(H*W, 3);
     for(uint i=0; i<image.d0; i++) {
       uint id = color2id(image.p+3*i);
       if(id<frameIDmap.N) {
@@ -116,17 +155,15 @@ void rai::CameraView::computeImageAndDepth(byteA& image, floatA& depth) {
         seg(i) = 0;
     }
     image = seg;
-    image.reshape(gl.height, gl.width);
+    image.reshape(H, W);
   }
   if(!!depth) {
-    depth = gl.captureDepth;
     flip_image(depth);
     for(float& d:depth) {
       if(d==1.f || d==0.f) d=-1.f;
-      else d = gl.camera.glConvertToTrueDepth(d);
+      else d = cam.glConvertToTrueDepth(d);
     }
   }
-  done(__func__);
 }
 
 void rai::CameraView::computeSegmentation(byteA& segmentation) {
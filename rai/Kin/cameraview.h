@@ -53,6 +53,9 @@ struct CameraView : GLDrawer {
 
   //-- compute/analyze a camera perspective (stored in classes' output fields)
   void computeImageAndDepth(byteA& image, floatA& depth);
+  /// renders all sensors in one pass, each into its own persistent offscreen framebuffer, and starts their asynchronous readback;
+  /// pipelined=true returns the images of the previous call (empty on the first), so that readback overlaps with the next step
+  void computeImageAndDepthAll(Array<byteA>& images, Array<floatA>& depths, bool pipelined=true);
   void computeKinectDepth(uint16A& kinect_depth, const arr& depth);
   void computePointCloud(arr& pts, const floatA& depth, bool globalCoordinates=true); // point cloud (rgb of every point is given in image)
   void computeSegmentation(byteA& segmentation);     // -> segmentation
@@ -64,6 +67,7 @@ struct CameraView : GLDrawer {
 
  private:
   void updateCamera();
+  void postProcess(byteA& image, floatA& depth, const rai::Camera& cam);
   void done(const char* _code_);
 };
 
@@ -10,6 +10,29 @@
 
 //===========================================================================
 
+void Feature::evalBatch(arr& Y, arr& J, const arr& Q, const FrameL& F) {
+  CHECK(F.N, "");
+  rai::Configuration& C = F.elem(0)->C;
+  CHECK_EQ(Q.nd, 2, "");
+  rai::Configuration::JacobianMode jacMode = C.jacMode;
+  C.jacMode = rai::Configuration::JM_dense;
+  arr q0 = C.getJointState();
+  for(uint i=0; i<Q.d0; i++) {
+    C.setJointState(Q[i]); //incremental: only the subtrees below changed joints are recomputed
+    arr y = eval(F);
+    if(!i) {
+      Y.resize(Q.d0, y.N);
+      if(!!J) J.resize(Q.d0, y.N, Q.d1);
+    }
+    Y[i] = y;
+    if(!!J) J[i] = y.J();
+  }
+  C.setJointState(q0);
+  C.jacMode = jacMode;
+}
+
+//===========================================================================
+
 arr Feature::phi_finiteDifferenceReduce(const FrameL& F) {
   CHECK(order>0, "can't reduce for order=0");
 
@@ -48,6 +48,7 @@ protected:
   arr eval(const FrameL& F) { arr y = phi(F); applyLinearTrans(y); return y; }
 //  Value eval(const FrameL& F) { arr y, J; eval(y, J, F); return Value(y, J); }
   arr eval(const rai::Configuration& C) { return eval(getFrames(C)); }
+  void evalBatch(arr& Y, arr& J, const arr& Q, const FrameL& F); ///< eval for each row of Q as joint state of F's configuration: Y.d0=Q.d0, J is (Q.d0, dim, Q.d1)
   uint dim(const FrameL& F) { uint d=dim_phi2(F); return applyLinearTrans_dim(d); }
   fct vf2(const FrameL& F);
 
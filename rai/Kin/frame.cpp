@@ -51,6 +51,7 @@ rai::Frame::Frame(Configuration& _C, const Frame* copyFrame)
 
   ID=C.frames.N;
   C.frames.append(this);
+  C._state_fwdOrder_isGood=false;
   if(copyFrame) {
     const Frame& f = *copyFrame;
     name=f.name; Q=f.Q; X=f.X; _state_X_isGood=f._state_X_isGood; tau=f.tau; ats=f.ats;
@@ -60,6 +61,7 @@ rai::Frame::Frame(Configuration& _C, const Frame* copyFrame)
     if(copyFrame->inertia) new Inertia(*this, copyFrame->inertia);
     if(copyFrame->particleDofs) new ParticleDofs(*this, copyFrame->particleDofs);
   }
+  if(C.frameNames.built) C.frameNames.add(name, this);
 }
 
 rai::Frame::Frame(Frame* _parent)
@@ -76,6 +78,8 @@ rai::Frame::~Frame() {
   if(inertia) delete inertia;
   if(parent) unLink();
   while(children.N) children.last()->unLink();
+  C._state_fwdOrder_isGood=false;
+  if(C.frameNames.built) C.frameNames.remove(name);
   if(this==C.frames.last()) { //great: this is very efficient to remove without breaking indexing
     CHECK_EQ(ID, C.frames.N-1, "");
     C.frames.resizeCopy(C.frames.N-1);
@@ -107,6 +111,7 @@ void rai::Frame::calc_X_from_parent() {
 
   _state_X_isGood=true;
   C._state_proxies_isGood = false;
+  C.calcXCount++;
 }
 
 void rai::Frame::calc_Q_from_parent(bool enforceWithinJoint) {
@@ -159,6 +164,7 @@ void rai::Frame::_state_updateAfterTouchingQ() {
 //  CHECK(parent, "can't set Q for a root frame '" <<name <<"'");
   if(!parent) LOG(-1) <<"can't set Q for a root frame '" <<name <<"'";
   _state_setXBadinBranch();
+  C._state_structureVersion++;
   if(joint && joint->dim) C._state_q_isGood = false;
 }
 
@@ -456,6 +462,7 @@ rai::Frame& rai::Frame::setPointCloud(const arr& points, const byteA& colors) {
   if(colors.N) {
     getShape().mesh().C.clear().operator=(convert<double>(byteA(colors))/255.).reshape(-1, 3);
   }
+  getShape().mesh().changed();
   return *this;
 }
 
@@ -475,11 +482,13 @@ rai::Frame& rai::Frame::setConvexMesh(const arr& points, const byteA& colors, do
   if(colors.N) {
     getShape().mesh().C.clear().operator=(convert<double>(byteA(colors))/255.).reshape(-1, 3);
   }
+  getShape().mesh().changed();
   return *this;
 }
 
 rai::Frame& rai::Frame::setColor(const arr& color) {
   getShape().mesh().C = color;
+  getShape().mesh().changed();
   return *this;
 }
 
@@ -592,6 +601,7 @@ void rai::Frame::unLink() {
   ensure_X();
   parent->children.removeValue(this);
   parent=nullptr;
+  C._state_fwdOrder_isGood=false;
   Q.setZero();
   if(joint) {  delete joint;  joint=nullptr;  }
 }
@@ -613,6 +623,7 @@ rai::Frame& rai::Frame::setParent(rai::Frame* _parent, bool keepAbsolutePose_and
 
   parent=_parent;
   parent->children.append(this);
+  C._state_fwdOrder_isGood=false;
 
   if(keepAbsolutePose_and_adaptRelativePose) calc_Q_from_parent();
   _state_updateAfterTouchingQ();
@@ -171,6 +171,7 @@ struct Frame : NonCopyable {
   arr getJointState() const; ///< throws error if this frame is not also a joint
 
   friend struct Configuration;
+  friend struct PackedKinematics;
   friend struct Configuration_ext;
   friend struct KinematicSwitch;
   friend struct Joint;
@@ -19,6 +19,7 @@
 #include "featureSymbols.h"
 #include "viewer.h"
 #include "../Core/graph.h"
+#include "../Core/thread.h"
 #include "../Geo/fclInterface.h"
 #include "../Geo/qhull.h"
 #include "../Geo/mesh_readAssimp.h"
@@ -42,7 +43,7 @@
 
 namespace rai {
 
-uint Configuration::setJointStateCount = 0;
+thread_local uint Configuration::setJointStateCount = 0;
 
 //===========================================================================
 //
@@ -128,6 +129,8 @@ struct sConfiguration {
   unique_ptr<PhysXInterface> physx;
   unique_ptr<OdeInterface> ode;
   unique_ptr<FeatherstoneInterface> fs;
+  unique_ptr<ThreadPool> batchPool;
+  uint batchPoolThreads=0;
 };
 
 Configuration::Configuration() {
@@ -354,10 +357,21 @@ void Configuration::addConfiguration(const Configuration& C, double tau){
 
 /// get first frame with given name
 Frame* Configuration::getFrame(const char* name, bool warnIfNotExist, bool reverse) const {
-  if(!reverse) {
-    for(Frame* b: frames) if(b->name==name) return b;
-  } else {
-    for(uint i=frames.N; i--;) if(frames.elem(i)->name==name) return frames.elem(i);
+  {
+    std::lock_guard<std::recursive_mutex> lock(frameNames.mutex);
+    if(!frameNames.built) {
+      for(Frame* f:frames) frameNames.add(f->name, f);
+      frameNames.built=true;
+    }
+    const std::vector<NameIndex::Entry>* E = frameNames.find(name);
+    if(E) {
+      Frame* f=0;
+      for(const NameIndex::Entry& e:*E) {
+        Frame* g=(Frame*)e.obj;
+        if(!f || (reverse ? g->ID>f->ID : g->ID<f->ID)) f=g;
+      }
+      return f;
+    }
   }
   if(warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"'");
   return 0;
@@ -551,12 +565,26 @@ void Configuration::setJointState(const arr& _q) {
   CHECK_EQ(_q.N, N, "wrong joint state dimensionalities");
 #endif
 
-  q=_q;
-
   proxies.clear();
+  _state_proxies_isGood=false;
+
+  //-- incremental: if q is in sync with the frames, only dofs whose q changed are set (and invalidate their subtrees)
+  if(_state_q_isGood && _state_indexedJoints_areGood && q.N==_q.N && !_q.jac) {
+    for(Dof* j:activeDofs) {
+      if(j->mimic) continue; //updated by the mimicked dof's setDofs
+      uint i=j->qIndex;
+      bool changed=false;
+      for(uint k=0; k<j->dim; k++) if(q.p[i+k]!=_q.p[i+k]) { changed=true; break; }
+      if(!changed) continue;
+      for(uint k=0; k<j->dim; k++) q.p[i+k] = _q.p[i+k];
+      j->setDofs(q, j->qIndex);
+    }
+    return;
+  }
+
+  q=_q;
 
   _state_q_isGood=true;
-  _state_proxies_isGood=false;
   for(Dof* j:activeDofs) {
     if(j->joint() && j->joint()->type!=JT_tau) {
       j->frame->_state_setXBadinBranch();
@@ -617,6 +645,7 @@ void Configuration::setFrameState(const arr& X, const FrameL& F) {
   }
   for(Frame* f:F) if(f->parent){
     f->Q.setDifference(f->parent->ensure_X(), f->X);
+    _state_structureVersion++;
     _state_q_isGood=false;
   }
 }
@@ -873,6 +902,20 @@ FrameL Configuration::calc_topSort() const {
   return order;
 }
 
+void Configuration::calc_fwdOrder() {
+  fwdOrder = getRoots();
+  if(frames.N) CHECK(fwdOrder.N, "none of the frames is a root -- must be loopy!");
+  for(uint i=0; i<fwdOrder.N; i++) fwdOrder.append(fwdOrder.elem(i)->children);
+  CHECK_EQ(fwdOrder.N, frames.N, "can't top sort");
+  _state_fwdOrder_isGood=true;
+  _state_structureVersion++;
+}
+
+void Configuration::ensure_X() {
+  if(!_state_fwdOrder_isGood) calc_fwdOrder();
+  for(Frame* f:fwdOrder) if(!f->_state_X_isGood && f->parent) f->calc_X_from_parent();
+}
+
 /// check if the current \ref frames is topologically sorted
 bool Configuration::check_topSort() const {
   //compute levels
@@ -1303,6 +1346,7 @@ void Configuration::calc_indexedActiveJoints(bool resetActiveJointSet) {
   }
 
   _state_indexedJoints_areGood=true;
+  _state_structureVersion++;
 
   //-- count active DOFs
   uint qcount=0;
@@ -1920,10 +1964,22 @@ std::shared_ptr<FclInterface> Configuration::fcl() {
   return self->fcl;
 }
 
+ThreadPool& Configuration::batchPool(uint numThreads) {
+  if(!self->batchPool || self->batchPoolThreads!=numThreads) {
+    self->batchPool = make_unique<ThreadPool>(numThreads);
+    self->batchPoolThreads = numThreads;
+  }
+  return *self->batchPool;
+}
+
 void Configuration::swiftDelete() {
   self->swift.reset();
 }
 
+void Configuration::fclDelete() {
+  self->fcl.reset();
+}
+
 /// return a PhysX extension
 PhysXInterface& Configuration::physx() {
   if(!self->physx) {
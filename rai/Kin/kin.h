@@ -18,6 +18,7 @@ struct PhysXInterface;
 struct SwiftInterface;
 struct OdeInterface;
 struct FeatherstoneInterface;
+struct ThreadPool;
 
 //===========================================================================
 
@@ -62,6 +63,7 @@ struct Configuration : GLDrawer {
 
   //-- fundamental structure
   FrameL frames;    ///< list of coordinate frames, with shapes, joints, inertias attached
+  mutable NameIndex frameNames; ///< name -> frames, for getFrame (built on the first query)
   DofL dofs;        ///< list of degrees of freedom
   ProxyA proxies;   ///< list of current collision proximities between frames
   arr q;            ///< the current configuration state (DOF) vector
@@ -72,13 +74,17 @@ struct Configuration : GLDrawer {
   bool _state_indexedJoints_areGood=false; // the active sets, incl. their topological sorting, are up to date
   bool _state_q_isGood=false; // the q-vector represents the current relative transforms (and force dofs)
   bool _state_proxies_isGood=false; // the proxies have been created for the current state
+  bool _state_fwdOrder_isGood=false; // fwdOrder is a topological sort of the current frame tree
+  FrameL fwdOrder;  ///< all frames, parents before children (computed with calc_fwdOrder()): the sweep order of ensure_X()
+  uint calcXCount=0;  ///< number of frame poses recomputed from their parent -- to measure the savings of incremental forward kinematics
+  uint _state_structureVersion=0; // incremented whenever fwdOrder, the dof indexing, or a constant relative transform changed (see PackedKinematics)
   //TODO: need a _state for all the plugin engines (SWIFT, PhysX)? To auto-reinitialize them when the config changed structurally?
 
   //-- format in which Jacobians are returned
   enum JacobianMode { JM_dense, JM_sparse, JM_rowShifted, JM_noArr, JM_emptyShape };
   JacobianMode jacMode = JM_dense;
 
-  static uint setJointStateCount;
+  static thread_local uint setJointStateCount; ///< per thread, so that concurrent KOMO runs count their own evaluations
 
   /// @name constructors
   Configuration();
@@ -185,11 +191,13 @@ struct Configuration : GLDrawer {
   void calc_Q_from_q();  ///< from q compute the joint's Q transformations
   void calcDofsFromConfig();  ///< updates q based on the joint's Q transformations
   arr calc_fwdPropagateVelocities(const arr& qdot);    ///< elementary forward kinematics
+  void calc_fwdOrder();  ///< topologically sort frames into fwdOrder
 
   /// @name ensure state consistencies
   void ensure_indexedJoints() {   if(!_state_indexedJoints_areGood) calc_indexedActiveJoints();  }
   void ensure_q() {  if(!_state_q_isGood) calcDofsFromConfig();  }
   void ensure_proxies() {  if(!_state_proxies_isGood) stepSwift();  }
+  void ensure_X();  ///< forward kinematics: recompute (only) the out-of-date frame poses, in a single sweep over fwdOrder
 
   /// @name Jacobians and kinematics (low level)
   void jacobian_pos(arr& J, Frame* a, const Vector& pos_world) const; //usually called internally with kinematicsPos
@@ -201,6 +209,7 @@ struct Configuration : GLDrawer {
 
   void kinematicsZero(arr& y, arr& J, uint n) const;
   void kinematicsPos(arr& y, arr& J, Frame* a, const Vector& rel=NoVector) const;
+  void kinematicsPosBatch(arr& Y, arr& J, const arr& Q, Frame* a, const Vector& rel=NoVector, uint numThreads=1); ///< for each row of Q (as joint state): position (Y.d0=Q.d0) and Jacobian (J.d0=Q.d0) -- on packed kinematics, without changing the state; numThreads=0 uses all hardware threads
   void kinematicsVec(arr& y, arr& J, Frame* a, const Vector& vec=NoVector) const;
   void kinematicsMat(arr& y, arr& J, Frame* a) const;
   void kinematicsQuat(arr& y, arr& J, Frame* a) const;
@@ -236,6 +245,7 @@ struct Configuration : GLDrawer {
   std::shared_ptr<SwiftInterface> swift();
   std::shared_ptr<FclInterface> fcl();
   void swiftDelete();
+  void fclDelete();
   PhysXInterface& physx();
   OdeInterface& ode();
   FeatherstoneInterface& fs();
@@ -269,6 +279,7 @@ struct Configuration : GLDrawer {
 
 private:
   void readFromGraph(const Graph& G, bool addInsteadOfClear=false);
+  ThreadPool& batchPool(uint numThreads); ///< kept across calls of kinematicsPosBatch (recreated when numThreads changes)
   friend struct KinematicSwitch;
   friend void editConfiguration(const char* orsfile, Configuration& G);
 };
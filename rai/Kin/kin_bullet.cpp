@@ -310,7 +310,7 @@ void BulletInterface::pushKinematicStates(const FrameL& frames) {
   }
 }
 
-void BulletInterface::pushFullState(const FrameL& frames, const arr& frameVelocities) {
+void BulletInterface::pushFullState(const FrameL& frames, const arr& frameVelocities, bool withCacheReset) {
   for(rai::Frame* f : frames) {
     if(self->actors.N <= f->ID) continue;
     btRigidBody* b = dynamic_cast<btRigidBody*>(self->actors(f->ID));
@@ -329,9 +329,35 @@ void BulletInterface::pushFullState(const FrameL& frames, const arr& frameVeloci
       }
     }
   }
+
+  if(withCacheReset) resetCaches();
+
   self->dynamicsWorld->stepSimulation(.01); //without this, two consequtive pushFullState won't work! (something active tag?)
 }
 
+void BulletInterface::resetCaches() {
+  //drop cached overlaps, contact manifolds and solver warm starts: re-adding all objects in their original order
+  //makes the continuation depend only on the pushed state (e.g., identical rollouts from the same snapshot)
+  btDiscreteDynamicsWorld* world = self->dynamicsWorld;
+  btCollisionObjectArray& objs = world->getCollisionObjectArray();
+  rai::Array<btCollisionObject*> all;
+  rai::Array<int> groups, masks;
+  for(int i=0; i<objs.size(); i++) {
+    if(btSoftBody::upcast(objs[i])) continue; //soft bodies stay (they need addSoftBody)
+    all.append(objs[i]);
+    groups.append(objs[i]->getBroadphaseHandle()->m_collisionFilterGroup);
+    masks.append(objs[i]->getBroadphaseHandle()->m_collisionFilterMask);
+  }
+  for(uint i=all.N; i--;) world->removeCollisionObject(all(i));
+  world->getBroadphase()->resetPool(world->getDispatcher());
+  world->getConstraintSolver()->reset();
+  for(uint i=0; i<all.N; i++) {
+    btRigidBody* b = btRigidBody::upcast(all(i));
+    if(b) world->addRigidBody(b, groups(i), masks(i));
+    else world->addCollisionObject(all(i), groups(i), masks(i));
+  }
+}
+
 btRigidBody* BulletInterface_self::addGround() {
   btTransform groundTransform;
   groundTransform.setIdentity();
@@ -857,7 +883,8 @@ void BulletBridge::pullPoses(rai::Configuration& C, bool alsoStaticAndKinematic)
 BulletInterface::BulletInterface(rai::Configuration& K, int verbose, bool yAxisGravity, bool enableSoftBodies) { NICO }
 BulletInterface::~BulletInterface() { NICO }
 void BulletInterface::step(double tau) { NICO }
-void BulletInterface::pushFullState(const FrameL& frames, const arr& vel) { NICO }
+void BulletInterface::pushFullState(const FrameL& frames, const arr& vel, bool withCacheReset) { NICO }
+void BulletInterface::resetCaches() { NICO }
 void BulletInterface::pushKinematicStates(const FrameL& frames) { NICO }
 void BulletInterface::pullDynamicStates(FrameL& frames, arr& vel) { NICO }
 void BulletInterface::saveBulletFile(const char* filename) { NICO }
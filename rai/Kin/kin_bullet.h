@@ -35,7 +35,8 @@ struct BulletInterface {
   void step(double tau=.01);
 
   void pushKinematicStates(const FrameL& frames);
-  void pushFullState(const FrameL& frames, const arr& frameVelocities=NoArr);
+  void pushFullState(const FrameL& frames, const arr& frameVelocities=NoArr, bool withCacheReset=false); ///< withCacheReset: also resetCaches, so that the continuation only depends on the pushed state
+  void resetCaches(); ///< drops broadphase pairs, contact manifolds and solver warm starts (removes and re-adds all rigid objects -- not for every step)
   void pullDynamicStates(FrameL& frames, arr& frameVelocities=NoArr);
 
   void changeObjectType(rai::Frame* f, int _type, const arr& withVelocity={});
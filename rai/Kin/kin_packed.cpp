@@ -0,0 +1,297 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "kin_packed.h"
+#include "frame.h"
+#include "../Core/thread.h"
+
+//===========================================================================
+
+namespace {
+//quaternions are (w,x,y,z) and assumed normalized
+
+inline void packed_quatMult(double* a, const double* b, const double* c) {
+  a[0] = b[0]*c[0] - b[1]*c[1] - b[2]*c[2] - b[3]*c[3];
+  a[1] = b[0]*c[1] + b[1]*c[0] + b[2]*c[3] - b[3]*c[2];
+  a[2] = b[0]*c[2] + b[2]*c[0] + b[3]*c[1] - b[1]*c[3];
+  a[3] = b[0]*c[3] + b[3]*c[0] + b[1]*c[2] - b[2]*c[1];
+}
+
+/// a = b + rot(q)*v
+inline void packed_quatApplyAdd(double* a, const double* b, const double* q, const double* v) {
+  //t = 2 u x v;  rot(q)v = v + w t + u x t
+  double tx = 2.*(q[2]*v[2] - q[3]*v[1]);
+  double ty = 2.*(q[3]*v[0] - q[1]*v[2]);
+  double tz = 2.*(q[1]*v[1] - q[2]*v[0]);
+  a[0] = b[0] + v[0] + q[0]*tx + (q[2]*tz - q[3]*ty);
+  a[1] = b[1] + v[1] + q[0]*ty + (q[3]*tx - q[1]*tz);
+  a[2] = b[2] + v[2] + q[0]*tz + (q[1]*ty - q[2]*tx);
+}
+
+inline void packed_quatNormalize(double* q) {
+  double n = ::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+  for(uint k=0; k<4; k++) q[k] /= n;
+}
+
+inline void packed_setPose(double* p, double* r, const rai::Transformation& X) {
+  p[0]=X.pos.x;  p[1]=X.pos.y;  p[2]=X.pos.z;
+  if(X.rot.isZero) { r[0]=1.;  r[1]=r[2]=r[3]=0.; }
+  else { r[0]=X.rot.w;  r[1]=X.rot.x;  r[2]=X.rot.y;  r[3]=X.rot.z; }
+}
+}
+
+//===========================================================================
+
+void rai::PackedKinematics::pack() {
+  C.ensure_indexedJoints();
+  if(!C._state_fwdOrder_isGood) C.calc_fwdOrder();
+  const FrameL& order = C.fwdOrder;
+  uint n = order.N;
+
+  frameIDs.resize(n);
+  index.resize(C.frames.N);
+  parent.resize(n);
+  type.resize(n);
+  qIndex.resize(n);
+  scale.resize(n);
+  Qpos.resize(n, 3).setZero();
+  Qrot.resize(n, 4).setZero();
+  pos.resize(n, 3).setZero();
+  rot.resize(n, 4).setZero();
+  axis.resize(n, 3).setZero();
+
+  for(uint i=0; i<n; i++) { frameIDs.p[i] = order.elem(i)->ID;  index.p[order.elem(i)->ID] = i; }
+
+  for(uint i=0; i<n; i++) {
+    Frame* f = order.elem(i);
+    Joint* j = f->joint;
+    parent.p[i] = f->parent ? (int)index.p[f->parent->ID] : -1;
+    qIndex.p[i] = -1;
+    scale.p[i] = j ? j->scale : 1.;
+    if(!f->parent) {
+      type.p[i] = PT_root;
+    } else if(!j || j->type==JT_rigid) {
+      type.p[i] = PT_const;
+      packed_setPose(Qpos.p+3*i, Qrot.p+4*i, f->Q);
+    } else if(!j->active) { //Q is set by qInactive
+      type.p[i] = PT_gather;
+    } else {
+      Joint* from = j; //a mimic joint copies the Q of the mimicked one, i.e., with its type and scale
+      if(j->mimic) { from = j->mimic;  scale.p[i] = from->scale; }
+      qIndex.p[i] = from->qIndex;
+      JointType jt = from->type;
+      if(from->mimic || j->type!=from->type) jt = JT_none; //chained mimics or a mimic of another type: not modelled
+      switch(jt) {
+        case JT_hingeX: type.p[i] = PT_hingeX;  break;
+        case JT_hingeY: type.p[i] = PT_hingeY;  break;
+        case JT_hingeZ: type.p[i] = PT_hingeZ;  break;
+        case JT_transX: type.p[i] = PT_transX;  break;
+        case JT_transY: type.p[i] = PT_transY;  break;
+        case JT_transZ: type.p[i] = PT_transZ;  break;
+        case JT_trans3: type.p[i] = PT_trans3;  break;
+        case JT_free: type.p[i] = PT_free;  break;
+        case JT_quatBall: type.p[i] = PT_quatBall;  break;
+        default: type.p[i] = PT_frameQ;  qIndex.p[i] = -1; //not modelled: Q is only consistent with C.q
+      }
+    }
+  }
+
+  version = C._state_structureVersion;
+}
+
+void rai::PackedKinematics::fwdKinematics(const arr& _q, bool setFrames) {
+  if(version!=C._state_structureVersion || !C._state_fwdOrder_isGood || !C._state_indexedJoints_areGood) pack();
+  CHECK_EQ(_q.N, C.getJointStateDimension(), "");
+  const double* q = _q.p;
+  uint n = frameIDs.N;
+
+  for(uint i=0; i<n; i++) {
+    double* Qp = Qpos.p+3*i;
+    double* Qr = Qrot.p+4*i;
+    double* ax = axis.p+3*i;
+    const double s = scale.p[i];
+    const double* qi = qIndex.p[i]>=0 ? q+qIndex.p[i] : nullptr;
+
+    //-- relative transform
+    switch(type.p[i]) {
+      case PT_root: packed_setPose(pos.p+3*i, rot.p+4*i, C.frames.elem(frameIDs.p[i])->X);  continue;
+      case PT_const: break;
+      case PT_gather: case PT_frameQ: packed_setPose(Qp, Qr, C.frames.elem(frameIDs.p[i])->Q);  break;
+      case PT_hingeX: case PT_hingeY: case PT_hingeZ: {
+        double a = .5*s*qi[0];
+        Qr[0]=::cos(a);  Qr[1]=Qr[2]=Qr[3]=0.;
+        Qr[1+type.p[i]-PT_hingeX] = ::sin(a);
+      } break;
+      case PT_transX: case PT_transY: case PT_transZ: {
+        Qp[0]=Qp[1]=Qp[2]=0.;
+        Qp[type.p[i]-PT_transX] = s*qi[0];
+        Qr[0]=1.;  Qr[1]=Qr[2]=Qr[3]=0.;
+      } break;
+      case PT_trans3: {
+        for(uint k=0; k<3; k++) Qp[k] = s*qi[k];
+        Qr[0]=1.;  Qr[1]=Qr[2]=Qr[3]=0.;
+      } break;
+      case PT_free: {
+        for(uint k=0; k<3; k++) Qp[k] = s*qi[k];
+        for(uint k=0; k<4; k++) Qr[k] = qi[3+k];
+        packed_quatNormalize(Qr);
+      } break;
+      case PT_quatBall: {
+        for(uint k=0; k<4; k++) Qr[k] = qi[k];
+        packed_quatNormalize(Qr);
+      } break;
+      default: NIY;
+    }
+
+    //-- absolute pose: X = X_parent * Q
+    const uint p = parent.p[i];
+    const double* rp = rot.p+4*p;
+    packed_quatApplyAdd(pos.p+3*i, pos.p+3*p, rp, Qp);
+    packed_quatMult(rot.p+4*i, rp, Qr);
+
+    //-- world axis of 1D joints (the parent's X/Y/Z axis)
+    if(type.p[i]>=PT_hingeX && type.p[i]<=PT_transZ) {
+      double e[3] = {0., 0., 0.}, zero[3] = {0., 0., 0.};
+      e[(type.p[i]-PT_hingeX)%3] = 1.;
+      packed_quatApplyAdd(ax, zero, rp, e);
+    }
+  }
+
+  if(setFrames) {
+    for(uint i=0; i<n; i++) if(type.p[i]!=PT_root) {
+      Frame* f = C.frames.elem(frameIDs.p[i]);
+      f->X.pos.set(pos.p+3*i);
+      f->X.rot.set(rot.p+4*i);
+      if(f->joint) { //same as in Frame::calc_X_from_parent
+        Joint* j = f->joint;
+        const Transformation& from = f->parent->X;
+        if(j->type==JT_hingeX || j->type==JT_transX || j->type==JT_XBall)  j->axis = from.rot.getX();
+        if(j->type==JT_hingeY || j->type==JT_transY)  j->axis = from.rot.getY();
+        if(j->type==JT_hingeZ || j->type==JT_transZ)  j->axis = from.rot.getZ();
+        if(j->type==JT_transXYPhi || j->type==JT_transYPhi)  j->axis = from.rot.getZ();
+        if(j->type==JT_phiTransXY)  j->axis = from.rot.getZ();
+      }
+      f->_state_X_isGood = true;
+    }
+    C._state_proxies_isGood = false;
+  }
+}
+
+void rai::PackedKinematics::jacobianPos(arr& J, uint frameID, const Vector& pos_world) const {
+  C.jacobian_zero(J, 3);
+  if(!J) return;
+
+  for(int i=index(frameID); i>=0 && parent.p[i]>=0; i=parent.p[i]) {
+    byte t = type.p[i];
+    if(t==PT_const || t==PT_gather) continue; //inactive joints don't contribute
+    if(t==PT_frameQ || t==PT_free || t==PT_quatBall) { C.jacobian_pos(J, C.frames.elem(frameID), pos_world);  return; }
+
+    uint qi = qIndex.p[i];
+    double s = scale.p[i];
+    const double* ax = axis.p+3*i;
+    if(t<=PT_hingeZ) {
+      const double* pi = pos.p+3*i;
+      double d[3] = { pos_world.x-pi[0], pos_world.y-pi[1], pos_world.z-pi[2] };
+      J.elem(0, qi) += s*(ax[1]*d[2] - ax[2]*d[1]);
+      J.elem(1, qi) += s*(ax[2]*d[0] - ax[0]*d[2]);
+      J.elem(2, qi) += s*(ax[0]*d[1] - ax[1]*d[0]);
+    } else if(t<=PT_transZ) {
+      for(uint k=0; k<3; k++) J.elem(k, qi) += s*ax[k];
+    } else if(t==PT_trans3) {
+      const double* rp = rot.p+4*parent.p[i];
+      double zero[3] = {0., 0., 0.};
+      for(uint c=0; c<3; c++) {
+        double e[3] = {0., 0., 0.}, col[3];
+        e[c] = 1.;
+        packed_quatApplyAdd(col, zero, rp, e);
+        for(uint k=0; k<3; k++) J.elem(k, qi+c) += s*col[k];
+      }
+    }
+  }
+}
+
+bool rai::PackedKinematics::posIsPacked(uint frameID) const {
+  for(int i=index(frameID); i>=0 && parent.p[i]>=0; i=parent.p[i]) {
+    if(type.p[i]==PT_frameQ) return false;
+  }
+  return true;
+}
+
+bool rai::PackedKinematics::jacobianPosIsPacked(uint frameID) const {
+  for(int i=index(frameID); i>=0 && parent.p[i]>=0; i=parent.p[i]) {
+    byte t = type.p[i];
+    if(t==PT_frameQ || t==PT_free || t==PT_quatBall) return false;
+  }
+  return true;
+}
+
+rai::Transformation rai::PackedKinematics::getPose(uint frameID) const {
+  uint i = index(frameID);
+  Transformation X;
+  X.pos.set(pos.p+3*i);
+  X.rot.set(rot.p+4*i);
+  return X;
+}
+
+//===========================================================================
+
+void rai::Configuration::kinematicsPosBatch(arr& Y, arr& J, const arr& Q, Frame* a, const Vector& rel, uint numThreads) {
+  CHECK_EQ(&a->C, this, "given frame is not element of this Configuration");
+  uint n = getJointStateDimension();
+  CHECK_EQ(Q.nd, 2, "");
+  CHECK_EQ(Q.d1, n, "");
+  uint N = Q.d0;
+
+  JacobianMode _jacMode = jacMode;
+  jacMode = JM_dense;
+  Y.resize(N, 3);
+  if(!!J) J.resize(N, 3, n).setZero();
+
+  PackedKinematics P(*this);
+  P.pack();
+
+  if(!P.jacobianPosIsPacked(a->ID)) { //joint types that only the frames can handle: one sample after the other
+    arr q0 = getJointState(), y, Ji;
+    for(uint i=0; i<N; i++) {
+      setJointState(Q[i]);
+      if(!!J) { kinematicsPos(y, Ji, a, rel);  J[i] = Ji; }
+      else kinematicsPos(y, NoArr, a, rel);
+      Y[i] = y;
+    }
+    setJointState(q0);
+    jacMode = _jacMode;
+    return;
+  }
+
+  auto sample = [&](PackedKinematics& Pt, uint i) {
+    Pt.fwdKinematics(Q[i]);
+    Transformation X = Pt.getPose(a->ID);
+    Vector pos = X.pos;
+    if(!!rel && !rel.isZero) pos += X.rot*rel;
+    Y(i, 0) = pos.x;  Y(i, 1) = pos.y;  Y(i, 2) = pos.z;
+    if(!!J) {
+      arr Ji;
+      Pt.jacobianPos(Ji, a->ID, pos);
+      memmove(J.p+i*3*n, Ji.p, 3*n*sizeof(double));
+    }
+  };
+
+  //-- small batches or a single thread: sweep in this thread
+  if(numThreads==1 || N<64) {
+    for(uint i=0; i<N; i++) sample(P, i);
+    jacMode = _jacMode;
+    return;
+  }
+
+  //-- each thread sweeps its own packed copy; the configuration is only read
+  ThreadPool& pool = batchPool(numThreads); //0: all hardware threads
+  std::vector<PackedKinematics> Ps(pool.size(), P);
+  pool.parallelFor(N, [&](uint i, uint t) { sample(Ps[t], i); });
+
+  jacMode = _jacMode;
+}
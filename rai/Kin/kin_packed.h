@@ -0,0 +1,48 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "kin.h"
+
+namespace rai {
+
+/// a packed (structure-of-arrays) copy of a configuration's kinematic tree: all frames in topological order,
+/// with contiguous parent indices, joint types, q-indices, relative and absolute poses. Forward kinematics and
+/// position Jacobians are then linear sweeps over these arrays, without touching the Frame objects.
+/// The packing is redone automatically when the structure of the configuration changed (C._state_structureVersion).
+struct PackedKinematics {
+  Configuration& C;
+
+  //-- structure (in C.fwdOrder)
+  uintA frameIDs;   ///< frame ID of each packed index
+  uintA index;      ///< packed index of each frame ID
+  intA parent;      ///< packed index of the parent (-1 for roots)
+  enum Type : byte { PT_root, PT_const, PT_gather, PT_frameQ, PT_hingeX, PT_hingeY, PT_hingeZ, PT_transX, PT_transY, PT_transZ, PT_trans3, PT_free, PT_quatBall };
+  byteA type;       ///< how the relative transform is obtained: from the frame (root, inactive joints; frameQ: active joints of other types), constant, or directly from q (also for mimic joints)
+  intA qIndex;      ///< qIndex of active joints (-1 otherwise)
+  arr scale;        ///< joint scale
+  uint version=UINT_MAX; ///< C._state_structureVersion at packing time
+
+  //-- state
+  arr Qpos, Qrot;   ///< (n,3) and (n,4) relative transforms
+  arr pos, rot;     ///< (n,3) and (n,4) absolute poses (quaternions as (w,x,y,z))
+  arr axis;         ///< (n,3) world axis of 1D joints
+
+  PackedKinematics(Configuration& _C) : C(_C) {}
+
+  void pack();                                ///< (re)build the structure arrays
+  void fwdKinematics(bool setFrames=false) { C.ensure_q(); fwdKinematics(C.q, setFrames); } ///< compute all poses from C.q; optionally write them back into the frames
+  void fwdKinematics(const arr& q, bool setFrames=false); ///< compute all poses from the given joint state (C.q is not touched); frames below PT_frameQ joints use the frame's current Q instead -- check posIsPacked
+  void jacobianPos(arr& J, uint frameID, const Vector& pos_world) const; ///< same as C.jacobian_pos, but on the packed arrays (after fwdKinematics)
+  bool posIsPacked(uint frameID) const; ///< whether the frame's pose depends on the given q only, i.e., no PT_frameQ joint above it
+  bool jacobianPosIsPacked(uint frameID) const; ///< whether jacobianPos covers all joints above the frame, i.e., never falls back to C.jacobian_pos (implies posIsPacked)
+  Transformation getPose(uint frameID) const;
+};
+
+} //namespace rai
@@ -46,8 +46,9 @@ struct Simulation_self {
 struct SimulationState {
   arr frameState;
   arr frameVels;
+  double time;
 
-  SimulationState(const arr& _frameState, const arr& _frameVels) : frameState(_frameState), frameVels(_frameVels) {}
+  SimulationState(const arr& _frameState, const arr& _frameVels, double _time=0.) : frameState(_frameState), frameVels(_frameVels), time(_time) {}
 };
 
 //===========================================================================
@@ -325,8 +326,9 @@ ptr<SimulationState> Simulation::getState() {
     self->physx->pullDynamicStates(C.frames, qdot);
   } else if(engine==_bullet) {
     self->bullet->pullDynamicStates(C.frames, qdot);
+  } else if(engine==_kinematic) {
   } else NIY;
-  return make_shared<SimulationState>(C.getFrameState(), qdot);
+  return make_shared<SimulationState>(C.getFrameState(), qdot, time);
 }
 
 void Simulation::setState(const arr& frameState, const arr& frameVelocities) {
@@ -334,11 +336,12 @@ void Simulation::setState(const arr& frameState, const arr& frameVelocities) {
   pushConfigurationToSimulator(frameVelocities);
 }
 
-void Simulation::pushConfigurationToSimulator(const arr& frameVelocities) {
+void Simulation::pushConfigurationToSimulator(const arr& frameVelocities, bool resetEngineCaches) {
   if(engine==_physx) {
     self->physx->pushFullState(C.frames, frameVelocities);
   } else if(engine==_bullet) {
-    self->bullet->pushFullState(C.frames, frameVelocities);
+    self->bullet->pushFullState(C.frames, frameVelocities, resetEngineCaches);
+  } else if(engine==_kinematic) {
   } else NIY;
 }
 
@@ -351,8 +354,10 @@ void Simulation::registerNewObjectWithEngine(Frame* f) {
   } else NIY;
 }
 
-void Simulation::restoreState(const ptr<SimulationState>& state) {
-  setState(state->frameState, state->frameVels);
+void Simulation::restoreState(const ptr<SimulationState>& state, bool resetEngineCaches) {
+  C.setFrameState(state->frameState);
+  pushConfigurationToSimulator(state->frameVels, resetEngineCaches);
+  time = state->time;
 }
 
 const arr& Simulation::get_qDot() {
@@ -430,6 +435,52 @@ void Simulation::getImageAndDepth(byteA& image, floatA& depth) {
   if(verbose>0) self->updateDisplayData(image, depth);
 }
 
+//===========================================================================
+
+SimulationRollouts::SimulationRollouts(Simulation& S, uint N, uint numThreads) {
+  configurations.resize(N);
+  sims.resize(N);
+  uintA graspIDs = framesToIndices(S.grasps);
+  for(uint i=0; i<N; i++) {
+    configurations(i) = make_shared<Configuration>(S.C);
+    sims(i) = make_shared<Simulation>(*configurations(i), S.engine, 0);
+    sims(i)->grasps = configurations(i)->getFrames(graspIDs);
+  }
+  pool = make_unique<ThreadPool>(numThreads);
+  setStart(S);
+}
+
+SimulationRollouts::~SimulationRollouts() {
+  sims.clear(); //engines refer to the configurations
+  configurations.clear();
+}
+
+void SimulationRollouts::setStart(Simulation& S) {
+  start = S.getState();
+}
+
+void SimulationRollouts::run(arr& X, const arr& U, double tau, Simulation::ControlMode u_mode, const uintA& frameIDs) {
+  uint N = sims.N;
+  CHECK(U.nd==2 || (U.nd==3 && U.d0==N), "controls need to be (T,d) or (N,T,d) with N=" <<N);
+  uint T = (U.nd==2 ? U.d0 : U.d1);
+  uint F = (frameIDs.N ? frameIDs.N : configurations(0)->frames.N);
+  X.resize(uintA{N, T+1, F, 7});
+  uint stride = F*7;
+
+  pool->parallelFor(N, [&](uint i, uint threadID) {
+    Simulation& S = *sims(i);
+    FrameL frames = (frameIDs.N ? S.C.getFrames(frameIDs) : S.C.frames);
+    S.restoreState(start, true);
+    double* x = X.p + i*(T+1)*stride;
+    memmove(x, S.C.getFrameState(frames).p, stride*sizeof(double));
+    for(uint t=0; t<T; t++) {
+      if(U.nd==2) S.step(U[t], tau, u_mode);
+      else S.step(U(i, t, {}), tau, u_mode);
+      memmove(x+(t+1)*stride, S.C.getFrameState(frames).p, stride*sizeof(double));
+    }
+  });
+}
+
 //===========================================================================
 //added-------------------------
 struct MoveBallHereCallback:OpenGL::GLClickCall {
@@ -10,6 +10,7 @@
 
 #include "kin.h"
 #include "cameraview.h"
+#include "../Core/thread.h"
 
 namespace rai {
 
@@ -84,13 +85,36 @@ struct Simulation {
 
   //-- store and reset the state of the simulation
   ptr<SimulationState> getState();
-  void restoreState(const ptr<SimulationState>& state);
+  void restoreState(const ptr<SimulationState>& state, bool resetEngineCaches=false); ///< resetEngineCaches: the continuation only depends on the state (bullet: drops contact and solver caches)
   void setState(const arr& frameState, const arr& frameVelocities=NoArr);
-  void pushConfigurationToSimulator(const arr& frameVelocities=NoArr);
+  void pushConfigurationToSimulator(const arr& frameVelocities=NoArr, bool resetEngineCaches=false);
 
   //-- post-hoc world manipulations
   void registerNewObjectWithEngine(rai::Frame* f);
 
 };
 
+//===========================================================================
+
+/// N independent simulations forked from a given one, each with its own Configuration copy and its own physics engine
+/// (created once, here in the constructor). run() resets all of them to the start state -- which pushes frame states
+/// and velocities into the engines and drops their contact/solver caches (restoreState with resetEngineCaches) --
+/// and steps them concurrently on a thread pool.
+/// Imps and the spline reference of the source simulation are not forked: control the rollouts with _position, _velocity or _none.
+struct SimulationRollouts {
+  Array<ptr<Configuration>> configurations;
+  Array<ptr<Simulation>> sims;
+  ptr<SimulationState> start;
+  std::unique_ptr<ThreadPool> pool;
+
+  SimulationRollouts(Simulation& S, uint N, uint numThreads=0);
+  ~SimulationRollouts();
+
+  void setStart(Simulation& S); ///< snapshot the current state of S as the new start state of all rollouts
+
+  /// resets all rollouts to the start state and applies controls U for T steps -- U is (T,d) for all rollouts, or (N,T,d) per rollout;
+  /// returns the packed trajectories X as (N,T+1,F,7) with the poses of frames F (default: all frames) before and after each step
+  void run(arr& X, const arr& U, double tau=.01, Simulation::ControlMode u_mode=Simulation::_position, const uintA& frameIDs={});
+};
+
 }
@@ -25,6 +25,7 @@ uint COUNT_kin=0;
 uint COUNT_node=0;
 uintA COUNT_opt=consts<uint>(0, BD_max);
 double COUNT_time=0.;
+double COUNT_setupTime=0.;
 String OptLGPDataPath;
 
 template<> const char* rai::Enum<BoundType>::names []= {
@@ -61,6 +62,7 @@ rai::SkeletonTranscription skeleton2Bound2(BoundType boundType, rai::Skeleton& S
 
 void LGP_Node::resetData() {
   skeleton.reset();
+  seqKeyframes.clear();
   cost = zeros(L);
   constraints = zeros(L);
   count = consts<uint>(0, L);
@@ -129,8 +131,16 @@ void LGP_Node::expand(int verbose) {
 }
 
 void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
+  if(!optBound_setup(bound, collisions, verbose)) return;
+  bool solved = optBound_solve(bound);
+  optBound_readout(bound, solved);
+}
+
+bool LGP_Node::optBound_setup(BoundType bound, bool collisions, int verbose, bool privateCollisionEngine) {
   if(tree.filComputes) (*tree.filComputes) <<id <<'-' <<step <<'-' <<bound <<endl;
+  double setupTime = -rai::cpuTime();
   ensure_skeleton();
+  tree.prepareKomoModel(collisions);
   skeleton->setConfiguration(tree.kin);
   skeleton->collisions = collisions;
   skeleton->verbose = verbose;
@@ -141,7 +151,6 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     waypoints = problem(BD_seq).komo->getPath_qAll();
   }
 
-#if 1
   try {
     problem(bound) = skeleton2Bound2(bound, *skeleton, waypoints);
   } catch(std::runtime_error& err) {
@@ -149,21 +158,22 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     if(tree.filComputes) (*tree.filComputes) <<"SKELETON->KOMO CRASHED:" <<*skeleton <<endl;
     feasible(bound) = false;
     labelInfeasible();
-    return;
+    return false;
   }
-#else
-  if(komoProblem(bound)) komoProblem(bound).reset();
-  komoProblem(bound) = make_shared<KOMO>();
-  komoProblem(bound)->verbose = rai::MAX(verbose, 0);
-  auto comp = skeleton2Bound(komoProblem(bound), bound, *skeleton,
-                             startKinematics,
-                             collisions,
-                             waypoints);
-  CHECK(comp, "no compute object returned");
-#endif
 
   ptr<KOMO>& komo = problem(bound).komo;
 
+  //-- the collision engine is shared with tree.kin by default; concurrent solves need their own
+  if(privateCollisionEngine) {
+    komo->world.swiftDelete();
+    komo->world.fclDelete();
+    if(komo->swift) komo->swift = komo->world.swift();
+    if(komo->fcl) komo->fcl = komo->world.fcl();
+  }
+
+  if(tree.useWarmStarts && (bound==BD_seq || bound==BD_pose)) warmStart(bound);
+  COUNT_setupTime += setupTime + rai::cpuTime();
+
   //-- verbosity...
   if(tree.verbose>1){
     if(komo->opt.verbose>0) {
@@ -192,27 +202,42 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     if(komo->opt.verbose>1) komo->reportProblem();
     if(komo->opt.verbose>5) komo->opt.animateOptimization = komo->opt.verbose-5;
   }
+  return true;
+}
 
-  //-- optimize
+bool LGP_Node::optBound_solve(BoundType bound) {
+  ptr<KOMO>& komo = problem(bound).komo;
+  solveTime = -rai::threadCpuTime();
   try {
     komo->run();
-
-//    NLP_Solver sol;
-//    sol.setProblem(*problem(bound).mp);
-//    auto ret = sol.solve();
-//    problem(bound).sol = sol.solve();
-
   } catch(std::runtime_error& err) {
     cout <<"KOMO CRASHED: " <<err.what() <<endl;
+    return false;
+  } catch(const char* err) {
+    cout <<"KOMO CRASHED: " <<err <<endl;
+    return false;
+  } catch(...) {
+    cout <<"KOMO CRASHED" <<endl;
+    return false;
+  }
+  kinEvals = Configuration::setJointStateCount;
+  solveTime += rai::threadCpuTime();
+  return true;
+}
+
+void LGP_Node::optBound_readout(BoundType bound, bool solved) {
+  if(!solved) {
     if(tree.filComputes) (*tree.filComputes) <<"KOMO CRASHED"<<endl;
     problem(bound).komo.reset();
     feasible(bound) = false;
     labelInfeasible();
     return;
   }
-  COUNT_kin += Configuration::setJointStateCount;
+
+  ptr<KOMO>& komo = problem(bound).komo;
+  COUNT_kin += kinEvals;
   COUNT_opt(bound)++;
-  COUNT_time += komo->timeTotal;
+  COUNT_time += solveTime;
   count(bound)++;
 
   DEBUG(komo->getReport(false, 1, FILE("z.problem")););
@@ -246,14 +271,47 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     cost(bound) = cost_here;
     constraints(bound) = constraints_here;
     feasible(bound) = feas;
-    computeTime(bound) = komo->timeTotal;
+    computeTime(bound) = solveTime;
   }
 
+  if(bound==BD_seq && feas) shareKeyframes(cost_here);
+
   if(!feasible(bound))
     labelInfeasible();
 }
 
 
+void LGP_Node::warmStart(BoundType bound) {
+  ptr<KOMO>& komo = problem(bound).komo;
+  arrA init;
+  if(bound==BD_seq) { //keyframes of the deepest prefix for which some terminal was solved
+    for(LGP_Node* p=parent; p; p=p->parent) if(p->seqKeyframes.N) { init = p->seqKeyframes; break; }
+  }
+  if(bound==BD_pose) { //the parent's final pose for the first slice
+    if(parent && parent->count(BD_pose) && parent->feasible(BD_pose) && parent->problem(BD_pose).komo)
+      init.append(parent->problem(BD_pose).komo->getPath_qAll().last());
+  }
+  uint t=0;
+  for(; t<init.N && t<komo->T; t++) {
+    if(komo->getConfiguration_qAll(t).N!=init(t).N) break; //slices beyond the shared prefix have different dofs
+    komo->setConfiguration_qAll(t, init(t));
+  }
+  if(t) komo->x = komo->pathConfig.getJointState();
+}
+
+void LGP_Node::shareKeyframes(double cost) {
+  arrA q = problem(BD_seq).komo->getPath_qAll();
+  for(LGP_Node* p=parent; p; p=p->parent) {
+    if(!p->skeleton) continue;
+    uint T = ceil(p->skeleton->getMaxPhase()); //BD_seq has one slice per phase
+    if(!T || T>q.N) continue;
+    if(p->seqKeyframes.N && p->seqKeyframesCost<=cost) continue;
+    p->seqKeyframes.resize(T);
+    for(uint t=0; t<T; t++) p->seqKeyframes(t) = q(t);
+    p->seqKeyframesCost = cost;
+  }
+}
+
 void LGP_Node::setInfeasible() {
   isInfeasible = true;
   for(LGP_Node* n:children) n->setInfeasible();
@@ -22,7 +22,7 @@ typedef Array<LGP_Node*> LGP_NodeL;
 
 extern uint COUNT_kin, COUNT_node;
 extern uintA COUNT_opt;
-extern double COUNT_time;
+extern double COUNT_time, COUNT_setupTime;
 extern String OptLGPDataPath;
 
 enum BoundType { BD_all=-1,
@@ -68,6 +68,10 @@ struct LGP_Node {
   uintA count;      ///< how often was this level evaluated
   arr computeTime;  ///< computation times for each level
   double highestBound=0.;
+  uint kinEvals=0;  ///< kinematic evaluations of the last solve
+  double solveTime=0.; ///< CPU time of the last solve (of this thread only -- komo->timeTotal counts all threads of the process)
+  arrA seqKeyframes;       ///< BD_seq keyframes of the best solved terminal below, up to this node's last phase -- warm start for all nodes sharing this skeleton prefix
+  double seqKeyframesCost=0.;
 
   // display helpers
   String note;
@@ -83,6 +87,10 @@ struct LGP_Node {
   //- computations on the node
   void expand(int verbose=0);           ///< expand this node (symbolically: compute possible decisions and add their effect nodes)
   void optBound(BoundType bound, bool collisions=false, int verbose=-1);
+  //-- optBound in three phases: only optBound_solve is thread safe (the tree runs it concurrently for several nodes)
+  bool optBound_setup(BoundType bound, bool collisions, int verbose, bool privateCollisionEngine=false); ///< create the KOMO problem; false if that crashed (node is labelled infeasible)
+  bool optBound_solve(BoundType bound); ///< run the KOMO problem; false if that crashed
+  void optBound_readout(BoundType bound, bool solved); ///< update counts, costs, and feasibility labels
   void resetData();
 
   //-- helpers to get other nodes
@@ -101,6 +109,8 @@ private:
   void labelInfeasible(); ///< sets this infeasible AND propagates this label up-down to others
   LGP_Node* treePolicy_random(); ///< returns leave -- by descending children randomly
   bool recomputeAllFolStates();
+  void warmStart(BoundType bound); ///< initialize the KOMO problem from solutions of the skeleton prefix
+  void shareKeyframes(double cost); ///< store the BD_seq solution in all ancestors
 
 public:
   void write(ostream& os=cout, bool recursive=false, bool path=true) const;
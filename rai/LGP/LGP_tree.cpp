@@ -118,6 +118,8 @@ LGP_Tree::LGP_Tree()
   displayTree = getParameter<bool>("LGP/displayTree", false);
 
   verbose = getParameter<double>("LGP/verbose", 1);
+  numThreads = getParameter<double>("LGP/numThreads", 1);
+  useWarmStarts = getParameter<bool>("LGP/warmStarts", false);
   if(verbose>1) fil.open(dataPath + "optLGP.dat"); //STRING("z.optLGP." <<rai::date() <<".dat"));
 
   cameraFocus = getParameter<arr>("LGP/cameraFocus", {});
@@ -137,7 +139,6 @@ LGP_Tree::LGP_Tree()
 
 LGP_Tree::LGP_Tree(const Configuration& _kin, const char* folFileName) : LGP_Tree() {
   kin.copy(_kin);
-  if(collisions) kin.swift(); //initialize swift in root model (SwiftInterface is reference by all child models)
   fol.init(folFileName);
   initFolStateFromKin(fol, kin);
   if(verbose>1) cout <<"INITIAL LOGIC STATE = " <<*fol.start_state <<endl;
@@ -535,6 +536,72 @@ void LGP_Tree::optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* ad
   }
 }
 
+void LGP_Tree::optConcurrently() {
+  struct Job { LGP_Node* n; BoundType bound; LGP_NodeL* addIfTerminal; bool setup, solved; };
+  Array<Job> jobs;
+
+  //-- draw up to numThreads nodes, round robin over the levels, closest-to-solution first
+  for(bool added=true; added && jobs.N<numThreads;) {
+    added=false;
+    LGP_Node* n = popBest(fringe_path, BD_seq);
+    if(n && !n->count(BD_seqPath)) { jobs.append({n, BD_seqPath, &fringe_solved, false, false}); added=true; }
+    if(jobs.N<numThreads) {
+      n = popBest(fringe_seq, BD_pose);
+      if(n && !n->count(BD_seq)) { jobs.append({n, BD_seq, &fringe_path, false, false}); added=true; }
+    }
+    if(jobs.N<numThreads && fringe_poseToGoal.N) {
+      n = fringe_poseToGoal.popFirst();
+      if(!n->count(BD_pose)) { jobs.append({n, BD_pose, &fringe_seq, false, false}); added=true; }
+    }
+  }
+  if(!jobs.N) return;
+
+  //-- setup serially (touches fol and rnd), solve concurrently, read out serially in job order -> deterministic
+  //   (during the solves, the global parameter graph is only accessed through its mutex token, getParameters())
+  for(Job& j:jobs) {
+    try {
+      j.setup = j.n->optBound_setup(j.bound, collisions, verbose-2, true);
+    } catch(...) {
+      LOG(-1) <<"opt(bound=" <<j.bound <<") setup has failed for node " <<j.n->getTreePathString();
+      j.n->optBound_readout(j.bound, false); //labels the node infeasible
+      j.setup = false;
+    }
+  }
+
+  if(!pool) pool = make_unique<ThreadPool>(numThreads);
+  pool->parallelFor(jobs.N, [&jobs](uint i, uint) {
+    Job& j = jobs(i);
+    if(!j.setup) return;
+    try {
+      j.solved = j.n->optBound_solve(j.bound);
+    } catch(...) { //a single failing bound must not abort the other jobs (parallelFor would rethrow)
+      j.solved = false;
+    }
+  });
+
+  for(Job& j:jobs) {
+    if(!j.setup) continue; //already labelled infeasible
+    try {
+      j.n->optBound_readout(j.bound, j.solved); //labels the node infeasible if not solved
+    } catch(const char* err) {
+      LOG(-1) <<"opt(bound=" <<j.bound <<") has failed for the following node:";
+      j.n->write(cout, false, true);
+      LOG(-3) <<"node optimization failed";
+    }
+    if(j.n->feasible(j.bound) && j.n->isTerminal) j.addIfTerminal->append(j.n);
+    focusNode = j.n;
+  }
+}
+
+void LGP_Tree::prepareKomoModel(bool collisions) {
+  //the world copy in KOMO::setModel references kin's engine (referenceSwiftOnCopy), so it is built only once per root;
+  //it needs to be the engine KOMO actually queries, otherwise each bound builds its own
+  kin.ensure_q();
+  if(!collisions) return;
+  if(rai::KOMO_Options().useFCL) kin.fcl();
+  else kin.swift();
+}
+
 void LGP_Tree::clearFromInfeasibles(LGP_NodeL& fringe) {
   for(uint i=fringe.N; i--;)
     if(fringe.elem(i)->isInfeasible) fringe.remove(i);
@@ -548,7 +615,7 @@ String LGP_Tree::report(bool detailed) {
   LGP_Node* bpath = getBest(fringe_solved, 3);
 
   String out;
-  out <<"TIME= " <<cpuTime() <<" TIME= " <<COUNT_time <<" KIN= " <<COUNT_kin << " TREE= " <<COUNT_node
+  out <<"TIME= " <<cpuTime() <<" TIME= " <<COUNT_time <<" SETUP= " <<COUNT_setupTime <<" KIN= " <<COUNT_kin << " TREE= " <<COUNT_node
       <<" POSE= " <<COUNT_opt(BD_pose) <<" SEQ= " <<COUNT_opt(BD_seq) <<" PATH= " <<COUNT_opt(BD_path)+COUNT_opt(BD_seqPath)
       <<" bestPose= " <<(bpose?bpose->cost(1):100.)
       <<" bestSeq= " <<(bseq ?bseq ->cost(2):100.)
@@ -571,11 +638,15 @@ void LGP_Tree::step() {
 
   uint numSol = fringe_solved.N;
 
+  if(numThreads>1) {
+    optConcurrently();
+  } else {
 //  if(rnd.uni()<.5) optBestOnLevel(BD_pose, fringe_pose, BD_symbolic, &fringe_seq, &fringe_pose);
-  optFirstOnLevel(BD_pose, fringe_poseToGoal, &fringe_seq);
-  optBestOnLevel(BD_seq, fringe_seq, BD_pose, &fringe_path, nullptr);
-  if(verbose>0 && fringe_path.N) cout <<"EVALUATING PATH " <<fringe_path.last()->getTreePathString() <<endl;
-  optBestOnLevel(BD_seqPath, fringe_path, BD_seq, &fringe_solved, nullptr);
+    optFirstOnLevel(BD_pose, fringe_poseToGoal, &fringe_seq);
+    optBestOnLevel(BD_seq, fringe_seq, BD_pose, &fringe_path, nullptr);
+    if(verbose>0 && fringe_path.N) cout <<"EVALUATING PATH " <<fringe_path.last()->getTreePathString() <<endl;
+    optBestOnLevel(BD_seqPath, fringe_path, BD_seq, &fringe_solved, nullptr);
+  }
 
   if(fringe_solved.N>numSol) {
     if(verbose>0) cout <<"NEW SOLUTION FOUND! " <<fringe_solved.last()->getTreePathString() <<endl;
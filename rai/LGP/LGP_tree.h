@@ -54,6 +54,9 @@ struct LGP_Tree : GLDrawer {
   String dataPath;
   arr cameraFocus;
   bool firstTimeDisplayTree=true;
+  bool useWarmStarts=false; ///< initialize BD_seq and BD_pose problems from solutions of their skeleton prefix (LGP/warmStarts; changes the search, hence opt-in)
+  uint numThreads=1; ///< >1: each step evaluates bounds of up to numThreads fringe nodes concurrently
+  unique_ptr<ThreadPool> pool;
 
   Array<std::shared_ptr<KinPathViewer>> views; //displays for the 3 different levels
 
@@ -85,9 +88,11 @@ struct LGP_Tree : GLDrawer {
 
   void optBestOnLevel(BoundType bound, LGP_NodeL& drawFringe, BoundType drawBound, LGP_NodeL* addIfTerminal, LGP_NodeL* addChildren);
   void optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* addIfTerminal);
+  void optConcurrently();
   void clearFromInfeasibles(LGP_NodeL& fringe);
 
  public:
+  void prepareKomoModel(bool collisions); ///< build the collision engine KOMO will query (swift or fcl) once in kin; all bounds copy their world from kin and share it
   void run(uint steps=10000);
   void init();
   void step();
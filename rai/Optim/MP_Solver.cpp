@@ -3,6 +3,7 @@
 #include "optimization.h"
 #include "gradient.h"
 #include "newton.h"
+#include "lbfgs.h"
 #include "opt-nlopt.h"
 #include "opt-ipopt.h"
 #include "opt-ceres.h"
@@ -44,6 +45,13 @@ shared_ptr<SolverReturn> MP_Solver::solve(int resampleInitialization){
     newton.run();
     ret->f = newton.fx;
   }
+  else if(solverID==MPS_LBFGS){
+    Conv_MathematicalProgram_ScalarProblem P1(P);
+    OptLBFGS lbfgs(x, P1, opt);
+    lbfgs.setBounds(P->bounds_lo, P->bounds_up);
+    lbfgs.run(opt.stopIters);
+    ret->f = lbfgs.fx;
+  }
   else if(solverID==MPS_gradientDescent){
     Conv_MathematicalProgram_ScalarProblem P1(P);
     OptGrad(x, P1).run();
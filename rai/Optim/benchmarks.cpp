@@ -76,6 +76,8 @@ double _RosenbrockFunction(arr& g, arr& H, const arr& x) {
   return f;
 }
 
+ScalarFunction RosenbrockFunction() { return _RosenbrockFunction; }
+
 struct MP_Rosenbrock : ScalarUnconstrainedProgram {
   MP_Rosenbrock(uint dim) { dimension=dim; }
   virtual double f(arr &g, arr &H, const arr &x){ return _RosenbrockFunction(g, H, x); }
@@ -97,6 +99,8 @@ double _RastriginFunction(arr& g, arr& H, const arr& x) {
   return f;
 }
 
+ScalarFunction RastriginFunction() { return _RastriginFunction; }
+
 struct MP_Rastrigin : ScalarUnconstrainedProgram {
   MP_Rastrigin(uint dim){ dimension=dim; }
   virtual uint getDimension(){ return dimension; }
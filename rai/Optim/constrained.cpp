@@ -218,3 +218,30 @@ uint OptConstrained::run() {
 OptConstrained::~OptConstrained() {
 }
 
+void OptConstrained::reinit(const rai::OptOptions& _opt) {
+  opt = _opt;
+  its = 0;
+  earlyPhase = false;
+
+  L.mu = L.nu = opt.muInit;
+  L.muLB = opt.muLBInit;
+  if(!!dual && dual.N) L.lambda = dual;
+  L.x.clear(); //forces re-evaluation: the problem may have changed (e.g. a shifted prefix) even if x did not
+
+  //the problem's bounds may have changed (e.g., a shifted prefix or changed joint limits)
+  newton.bounds_lo.clear();
+  newton.bounds_up.clear();
+  if(opt.boundedNewton){
+    arr lo, up;
+    L.P->getBounds(lo, up);
+    if(lo.N || up.N) newton.setBounds(lo, up);
+  }
+
+  newton.options = opt;
+  newton.options.verbose = rai::MAX(opt.verbose-1, 0);
+  newton.its = newton.evals = newton.numTinyFSteps = newton.numTinyXSteps = 0;
+  newton.alpha = opt.initStep;
+  newton.beta = opt.damping;
+  newton.timeNewton = newton.timeEval = 0.;
+}
+
@@ -31,7 +31,7 @@ struct OptConstrained {
   ~OptConstrained();
   bool step();
   uint run();
-//  void reinit();
+  void reinit(const rai::OptOptions& _opt); ///< prepare another run() on the (possibly changed) problem: restarts the iteration counters and penalty schedule, refreshes Newton's bounds from the problem, keeps the multipliers (from dual) as warm start and all buffers and Newton's sparse symbolic analysis
 };
 
 //==============================================================================
@@ -0,0 +1,274 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "lbfgs.h"
+#include "optimization.h"
+
+#include <iomanip>
+
+int optLBFGS(arr& x, const ScalarFunction& f, rai::OptOptions o) {
+  return OptLBFGS(x, f, o).run();
+}
+
+//===========================================================================
+
+OptLBFGS::OptLBFGS(arr& _x, const ScalarFunction& _f, rai::OptOptions _o, uint _m):
+  x(_x), f(_f), options(_o), m(_m) {
+  alpha = options.initStep;
+}
+
+OptLBFGS& OptLBFGS::setBounds(const arr& _bounds_lo, const arr& _bounds_up) {
+  bounds_lo = _bounds_lo;
+  bounds_up = _bounds_up;
+  return *this;
+}
+
+void OptLBFGS::reinit(const arr& _x) {
+  if(&x!=&_x) x = _x;
+  uint n=x.N;
+
+  bounded=false;
+  if(bounds_lo.N && bounds_up.N) {
+    CHECK_EQ(bounds_lo.N, n, "");
+    CHECK_EQ(bounds_up.N, n, "");
+    for(uint i=0; i<n; i++) if(bounds_up.p[i]>=bounds_lo.p[i]) bounded=true;
+    boundClip(x, bounds_lo, bounds_up);
+  }
+
+  S.resize(m, n);  Y.resize(m, n);  rho.resize(m);  coeff.resize(m);
+  dir.resize(n);  y.resize(n);  gy.resize(n);  ylo.resize(n);  glo.resize(n);
+  fixed.resize(n).setZero();
+  head=used=0;
+
+  fx = evaluate(x, gx);
+
+  //startup verbose
+  if(options.verbose>1) cout <<"*** optLBFGS: initial point f(x)=" <<fx <<" m=" <<m <<" bounded=" <<bounded <<endl;
+  if(options.verbose>3) { if(x.N<5) cout <<"x=" <<x <<endl; }
+}
+
+//===========================================================================
+
+void OptLBFGS::computeDirection() {
+  uint n=x.N;
+  double* d=dir.p;
+  const double* g=gx.p;
+
+  //-- variables at a bound that the gradient pushes against are fixed
+  if(bounded) {
+    for(uint i=0; i<n; i++) {
+      fixed.p[i] = bounds_up.p[i]>=bounds_lo.p[i]
+                   && ((x.p[i]<=bounds_lo.p[i] && g[i]>0.) || (x.p[i]>=bounds_up.p[i] && g[i]<0.));
+    }
+  }
+
+  //-- two-loop recursion on the free variables
+  for(uint i=0; i<n; i++) d[i] = fixed.p[i] ? 0. : -g[i];
+  uint k=head;
+  for(uint l=0; l<used; l++) {
+    k = (k+m-1)%m; //newest first
+    const double* s=S.p+k*n;
+    double a=0.;
+    for(uint i=0; i<n; i++) a += s[i]*d[i];
+    a *= rho.p[k];
+    coeff.p[k] = a;
+    const double* yk=Y.p+k*n;
+    for(uint i=0; i<n; i++) d[i] -= a*yk[i];
+  }
+  if(used) {
+    uint last=(head+m-1)%m;
+    const double* yk=Y.p+last*n;
+    double yy=0.;
+    for(uint i=0; i<n; i++) yy += yk[i]*yk[i];
+    double gamma = 1./(rho.p[last]*yy); //initial inverse Hessian scaling s^T y / y^T y
+    for(uint i=0; i<n; i++) d[i] *= gamma;
+  }
+  for(uint l=0; l<used; l++) { //oldest first
+    const double* s=S.p+k*n, *yk=Y.p+k*n;
+    double b=0.;
+    for(uint i=0; i<n; i++) b += yk[i]*d[i];
+    b *= rho.p[k];
+    for(uint i=0; i<n; i++) d[i] += (coeff.p[k]-b)*s[i];
+    k = (k+1)%m;
+  }
+  if(bounded) for(uint i=0; i<n; i++) if(fixed.p[i]) d[i]=0.;
+
+  //-- fall back to steepest descent if the memory does not give a descent direction
+  double gd=0.;
+  for(uint i=0; i<n; i++) gd += g[i]*d[i];
+  if(!(gd<0.)) {
+    if(options.verbose>1) cout <<" (reset memory)" <<flush;
+    used=0;
+    for(uint i=0; i<n; i++) d[i] = fixed.p[i] ? 0. : -g[i];
+  }
+}
+
+//-- strong Wolfe line search along dir [Nocedal & Wright, Alg. 3.5/3.6]
+bool OptLBFGS::lineSearchWolfe(double& fy) {
+  uint n=x.N;
+  const double c1=options.wolfe, c2=.9;
+  double g0=0.;
+  for(uint i=0; i<n; i++) g0 += gx.p[i]*dir.p[i];
+
+  auto probe = [&](double a, double& dphi) {
+    for(uint i=0; i<n; i++) y.p[i] = x.p[i] + a*dir.p[i];
+    double fa = evaluate(y, gy);
+    dphi=0.;
+    for(uint i=0; i<n; i++) dphi += gy.p[i]*dir.p[i];
+    if(options.verbose>2) cout <<"\n  (line search) alpha=" <<a <<" f=" <<fa <<" dphi=" <<dphi <<flush;
+    return fa;
+  };
+
+  double aLo=0., fLo=fx, dLo=g0, aHi=0., fHi=0., dHi=0.;
+  double a=alpha, dphi;
+  bool zoom=false;
+  int maxSteps = 2*options.stopLineSteps;
+
+  //-- bracketing
+  for(int k=0; k<maxSteps && !zoom; k++) {
+    fy = probe(a, dphi);
+    if(!(fy==fy) || fy > fx + c1*a*g0 || (k>0 && fy>=fLo)) { aHi=a; fHi=fy; dHi=dphi; zoom=true; break; }
+    if(fabs(dphi) <= -c2*g0) { alpha=a; return true; }
+    if(dphi>=0.) { aHi=aLo; fHi=fLo; dHi=dLo; aLo=a; fLo=fy; dLo=dphi; ylo=y; glo=gy; zoom=true; break; }
+    aLo=a; fLo=fy; dLo=dphi; ylo=y; glo=gy;
+    a *= 2.;
+  }
+
+  //-- zoom
+  for(int k=0; zoom && k<maxSteps; k++) {
+    //cubic interpolation between the bracket ends, safeguarded to the inner 80% of the bracket
+    double d1 = dLo + dHi - 3.*(fLo-fHi)/(aLo-aHi);
+    double d2sq = d1*d1 - dLo*dHi;
+    double lo=rai::MIN(aLo, aHi), hi=rai::MAX(aLo, aHi), w=hi-lo;
+    double aj;
+    if(fHi==fHi && d2sq>=0.) {
+      double d2 = (aHi>aLo ? 1. : -1.)*sqrt(d2sq);
+      aj = aHi - (aHi-aLo)*(dHi+d2-d1)/(dHi-dLo+2.*d2);
+    } else aj = .5*(aLo+aHi);
+    if(!(aj>=lo+.1*w && aj<=hi-.1*w)) aj = .5*(aLo+aHi);
+
+    fy = probe(aj, dphi);
+    if(!(fy==fy) || fy > fx + c1*aj*g0 || fy>=fLo) {
+      aHi=aj; fHi=fy; dHi=dphi;
+    } else {
+      if(fabs(dphi) <= -c2*g0) { alpha=aj; return true; }
+      if(dphi*(aHi-aLo)>=0.) { aHi=aLo; fHi=fLo; dHi=dLo; }
+      aLo=aj; fLo=fy; dLo=dphi; ylo=y; glo=gy;
+    }
+    if(w<1e-12*hi) break;
+  }
+
+  //-- no strong Wolfe point found: take the best sufficient-decrease point, if any
+  if(aLo>0.) {
+    alpha=aLo; fy=fLo; y=ylo; gy=glo;
+    return true;
+  }
+  return false;
+}
+
+//-- projected backtracking along the (bound-clipped) path x+a*dir
+bool OptLBFGS::lineSearchProjected(double& fy) {
+  uint n=x.N;
+  double a=alpha;
+  for(int k=0; k<2*options.stopLineSteps; k++) {
+    for(uint i=0; i<n; i++) {
+      double v = x.p[i] + a*dir.p[i];
+      if(bounds_up.p[i]>=bounds_lo.p[i]) {
+        if(v>bounds_up.p[i]) v=bounds_up.p[i];
+        if(v<bounds_lo.p[i]) v=bounds_lo.p[i];
+      }
+      y.p[i] = v;
+    }
+    fy = evaluate(y, gy);
+    double gs=0.;
+    for(uint i=0; i<n; i++) gs += gx.p[i]*(y.p[i]-x.p[i]);
+    if(options.verbose>2) cout <<"\n  (line search) alpha=" <<a <<" f=" <<fy <<flush;
+    if(fy==fy && fy <= fx + options.wolfe*gs) { alpha=a; return true; }
+    a *= options.stepDec;
+  }
+  return false;
+}
+
+void OptLBFGS::updateMemory() {
+  //store s=y-x and g(y)-g(x), if the curvature condition holds
+  uint n=x.N;
+  double* s=S.p+head*n, *yk=Y.p+head*n;
+  double sy=0., yy=0.;
+  for(uint i=0; i<n; i++) {
+    s[i] = y.p[i]-x.p[i];
+    yk[i] = gy.p[i]-gx.p[i];
+    sy += s[i]*yk[i];
+    yy += yk[i]*yk[i];
+  }
+  if(sy > 1e-12*yy && yy>0.) {
+    rho.p[head] = 1./sy;
+    head = (head+1)%m;
+    if(used<m) used++;
+  }
+}
+
+//===========================================================================
+
+OptLBFGS::StopCriterion OptLBFGS::step() {
+  if(!evals) reinit(x);
+
+  its++;
+  if(options.verbose>1) cout <<"optLBFGS it:" <<std::setw(4) <<its <<flush;
+
+  if(!(fx==fx)) HALT("you're calling an L-BFGS step with initial function value = NAN");
+
+  computeDirection();
+  double maxDelta = absMax(dir);
+
+  //the first step (without memory) is scaled to maxStep; later steps try the full quasi-Newton step first
+  alpha = 1.;
+  if(!used && options.maxStep>0. && maxDelta>options.maxStep) alpha = options.maxStep/maxDelta;
+
+  double fy=fx;
+  bool success=false;
+  if(maxDelta<1e-1*options.stopTolerance) {
+    if(options.verbose>1) cout <<" \t -- absMax(dir)<1e-1*o.stopTolerance -- NO UPDATE" <<endl;
+  } else {
+    success = bounded ? lineSearchProjected(fy) : lineSearchWolfe(fy);
+    if(!success && options.verbose>1) cout <<" \tevals:" <<std::setw(4) <<evals <<" - line search failed" <<endl;
+  }
+
+  if(success) {
+    if(options.verbose>1) cout <<" \tevals:" <<std::setw(4) <<evals <<" \talpha:" <<std::setw(11) <<alpha <<" \tf(y):" <<fy <<" - ACCEPT" <<endl;
+    if(options.stopFTolerance>0. && fx-fy<options.stopFTolerance) numTinyFSteps++; else numTinyFSteps=0;
+    updateMemory();
+    x = y;  gx = gy;  fx = fy; //these are copies into existing memory
+  }
+
+  double gMax=0.;
+  for(uint i=0; i<x.N; i++) if(!fixed.p[i]) gMax = rai::MAX(gMax, fabs(gx.p[i]));
+
+  //stopping criteria
+#define STOPIF(expr, code, ret) if(expr){ if(options.verbose>1) cout <<"\t\t\t\t\t\t--- stopping criterion='" <<#expr <<"'" <<endl; code; return stopCriterion=ret; }
+  STOPIF(maxDelta<options.stopTolerance,, stopDeltaConverge);
+  STOPIF(options.stopGTolerance>0. && gMax<options.stopGTolerance,, stopGradConverge);
+  STOPIF(!success && !used,, stopLineSearchFailed);
+  if(!success) used=0; //retry once from steepest descent
+  STOPIF(numTinyFSteps>4, numTinyFSteps=0, stopTinyFSteps);
+  STOPIF(evals>=options.stopEvals,, stopCritEvals);
+  STOPIF(its>=options.stopIters,, stopCritIters);
+#undef STOPIF
+
+  return stopCriterion=stopNone;
+}
+
+OptLBFGS::StopCriterion OptLBFGS::run(uint maxIt) {
+  numTinyFSteps=0;
+  for(uint i=0; i<maxIt; i++) {
+    step();
+    if(stopCriterion>=stopDeltaConverge) break;
+  }
+  if(stopCriterion==stopNone) stopCriterion=stopCritIters; //ran out of maxIt
+  if(options.verbose>1) cout <<"--- optLBFGSStop: f(x)=" <<fx <<" its=" <<its <<" evals=" <<evals <<endl;
+  return stopCriterion;
+}
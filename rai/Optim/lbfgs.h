@@ -0,0 +1,59 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "options.h"
+#include "../Core/array.h"
+
+//===========================================================================
+//
+// limited-memory BFGS
+//
+
+int optLBFGS(arr& x, const ScalarFunction& f, rai::OptOptions opt=NOOPT);
+
+/** L-BFGS: quasi-Newton with the inverse Hessian approximated from the last m correction pairs (two-loop recursion);
+ *  f is only queried for gradients (H=NoArr). Without bounds, steps are chosen with a strong-Wolfe line search;
+ *  with bounds (bounds_up>=bounds_lo per entry), variables at an active bound are fixed for the direction and
+ *  the step is a projected backtracking (Armijo) search. All buffers are allocated in reinit, not per iteration. */
+struct OptLBFGS {
+  arr& x;
+  ScalarFunction f;
+  rai::OptOptions options;
+  uint m;            ///< number of stored correction pairs
+
+  enum StopCriterion { stopNone=0, stopDeltaConverge, stopGradConverge, stopTinyFSteps, stopCritEvals, stopCritIters, stopLineSearchFailed };
+
+  OptLBFGS(arr& x, const ScalarFunction& f, rai::OptOptions options=NOOPT, uint m=10);
+  OptLBFGS& setBounds(const arr& _bounds_lo, const arr& _bounds_up);
+  void reinit(const arr& _x);
+
+  StopCriterion step();
+  StopCriterion run(uint maxIt = 1000);
+
+public:
+  double fx, alpha;
+  arr gx;
+  int its=0, evals=0, numTinyFSteps=0;
+  StopCriterion stopCriterion=stopNone;
+  arr bounds_lo, bounds_up;
+
+private:
+  arr S, Y, rho, coeff; ///< (m,n) ring buffers of steps and gradient differences, 1/(y^T s), two-loop coefficients
+  uint head=0, used=0;
+  arr dir, y, gy, ylo, glo; ///< search direction, trial point/gradient, best line search point/gradient
+  byteA fixed;          ///< variables at an active bound
+  bool bounded=false;
+
+  double evaluate(const arr& z, arr& g) { evals++; return f(g, NoArr, z); }
+  void computeDirection();
+  bool lineSearchWolfe(double& fy);
+  bool lineSearchProjected(double& fy);
+  void updateMemory();
+};
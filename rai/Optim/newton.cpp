@@ -103,6 +103,12 @@ OptNewton::StopCriterion OptNewton::step() {
             s.Z.elem(k) = 0.;
           }
         }
+      } else if(isRowShifted(R)) {
+        rai::RowShifted& r = R.rowShifted();
+        for(uint i=0; i<R.d0; i++) for(uint k=0; k<r.rowLen(i); k++) {
+          uint j = r.rowShift(i)+k;
+          if(i!=j && (boundActive.elem(i) || boundActive.elem(j))) r.entry(i, k) = 0.;
+        }
       } else NIY;
       if(options.verbose>5) cout <<"  boundActive:" <<boundActive;
     }
@@ -129,7 +135,15 @@ OptNewton::StopCriterion OptNewton::step() {
     bool inversionFailed=false;
     try {
       if(!rootFinding) {
-        Delta = lapack_Ainv_b_sym(R, -gx);
+        if(isSparseMatrix(R)) { //pos-def check is the success of the Cholesky factorization
+          if(sparseCholesky.factor(R)) Delta = sparseCholesky.solve(-gx);
+          else inversionFailed=true;
+        } else if(isRowShifted(R)) { //banded (e.g. JM_rowShifted): factorize in place
+          if(R.rowShifted().cholesky()) Delta = R.rowShifted().cholesky_solve(-gx);
+          else inversionFailed=true;
+        } else {
+          Delta = lapack_Ainv_b_sym(R, -gx);
+        }
       } else {
         lapack_mldivide(Delta, R, -gx);
       }
@@ -87,6 +87,7 @@ inline void accumulateInequalities(arr& y, arr& J, const arr& yAll, const arr& J
 // optimization algorithms declared separately:
 #include "newton.h"
 #include "gradient.h"
+#include "lbfgs.h"
 //#include "lagrangian.h"
 //#include "convert.h"
 //uint optGradDescent(arr& x, const ScalarFunction& f, OptOptions opt);
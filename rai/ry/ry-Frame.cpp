@@ -188,6 +188,7 @@ void init_Frame(pybind11::module& m) {
       T(i, 0) = 2*i;
       T(i, 1) = 2*i+1;
     }
+    self->shape->mesh().changed();
     checkView(self, true);
   })
   ;
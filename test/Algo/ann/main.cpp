@@ -1,4 +1,5 @@
 #include <Core/util.h>
+#include <Core/thread.h>
 #include <Algo/ann.h>
 
 void TEST(ANN) {
@@ -44,6 +45,80 @@ void TEST(ANNIncremental) {
   }
 }
 
+//===========================================================================
+
+//brute force reference
+void bruteKNN(arr& dists, intA& idx, const arr& X, const arr& x, uint k){
+  arr d(X.d0);
+  for(uint i=0;i<X.d0;i++) d(i) = sqrDistance(X[i], x);
+  idx.resize(X.d0);
+  for(uint i=0;i<idx.N;i++) idx(i)=i;
+  std::partial_sort(idx.p, idx.p+k, idx.p+idx.N, [&d](int i, int j){ return d(i)<d(j); });
+  idx.resizeCopy(k);
+  dists.resize(k);
+  for(uint i=0;i<k;i++) dists(i) = d(idx(i));
+}
+
+void TEST(KNN){
+  //exact queries after incremental insertion (across merges of the forest) and after a full rebuild
+  uint dim=4, k=5;
+  ANN ann;
+  arr x(dim), q(dim), dists, refDists;
+  intA idx, refIdx;
+  for(uint n=0;n<3000;n++){
+    rndUniform(x, 0., 1., false);
+    ann.append(x);
+    if(n>=k && !(n%37)){
+      rndUniform(q, 0., 1., false);
+      ann.getkNN(dists, idx, q, k);
+      bruteKNN(refDists, refIdx, ann.X, q, k);
+      CHECK_ZERO(maxDiff(dists, refDists), 1e-12, "kNN distances differ at n=" <<n);
+    }
+  }
+
+  //batched queries, threaded
+  arr Q = rand(1000, dim);
+  arr D1, D2;
+  intA I1, I2;
+  ann.getkNNs(D1, I1, Q, k);
+  ThreadPool pool(4);
+  ann.getkNNs(D2, I2, Q, k, 0., &pool);
+  CHECK_ZERO(maxDiff(D1, D2), 0., "threaded queries differ");
+  for(uint i=0;i<Q.d0;i+=100){
+    bruteKNN(refDists, refIdx, ann.X, Q[i], k);
+    CHECK_ZERO(maxDiff(D1[i], refDists), 1e-12, "batched kNN distances differ");
+  }
+
+  ann.calculate();
+  ann.getkNN(dists, idx, q, k);
+  bruteKNN(refDists, refIdx, ann.X, q, k);
+  CHECK_ZERO(maxDiff(dists, refDists), 1e-12, "kNN distances differ after calculate");
+
+  //X changed from outside: shrunk, replaced by a larger set, replaced in place by a same-size set
+  ann.X.resizeCopy(100, dim);
+  ann.getkNN(dists, idx, q, k);
+  bruteKNN(refDists, refIdx, ann.X, q, k);
+  CHECK_ZERO(maxDiff(dists, refDists), 1e-12, "kNN distances differ after shrinking X");
+  for(uint i=0;i<idx.N;i++) CHECK_LE(idx(i), 99, "index beyond the shrunk X");
+
+  ann.X = rand(2000, dim);
+  ann.getkNN(dists, idx, q, k);
+  bruteKNN(refDists, refIdx, ann.X, q, k);
+  CHECK_ZERO(maxDiff(dists, refDists), 1e-12, "kNN distances differ after replacing X");
+
+  double* p=ann.X.p;
+  ann.X = rand(2000, dim);
+  CHECK_EQ(p, ann.X.p, "same-size assignment should keep the memory");
+  ann.getkNNs(D1, I1, Q, k);
+  for(uint i=0;i<Q.d0;i+=100){
+    bruteKNN(refDists, refIdx, ann.X, Q[i], k);
+    CHECK_ZERO(maxDiff(D1[i], refDists), 1e-12, "batched kNN distances differ after replacing X in place");
+  }
+  cout <<"kNN: OK" <<endl;
+}
+
+//===========================================================================
+
 /*void TEST(ANNregression){
   doubleA X,Y,Z;
   uint i,j;
@@ -77,6 +152,7 @@ int MAIN(int argc,char** argv){
 
   testANN();
   testANNIncremental();
+  testKNN();
   //testANNregression();
 
   return 0;
@@ -0,0 +1,72 @@
+#include <Core/util.h>
+#include <Algo/priorityQueue.h>
+
+//===========================================================================
+
+//the previous implementation: an array kept sorted by insertInSorted -- used as reference
+struct SortedQueue : rai::Array<PriorityQueueEntry<uint>> {
+  SortedQueue(){ memMove=true; }
+  void add(double p, uint x, bool fromBackIfEqual=false){
+    PriorityQueueEntry<uint> e = {p, x, 0};
+    insertInSorted(e, PriorityQueueEntry<uint>::cmp, fromBackIfEqual);
+  }
+  uint pop(){ uint x=first().x; remove(0); return x; }
+};
+
+void TEST(Order){
+  //same pop order as the sorted reference, including FIFO/LIFO tie-breaking (priorities are drawn from few values)
+  PriorityQueue<uint> Q;
+  SortedQueue S;
+  for(uint k=0;k<100000;k++){
+    if(!Q.N || rnd.uni()<.6){
+      double p = rnd(10);
+      bool fromBack = rnd.uni()<.5;
+      Q.add(p, k, fromBack);
+      S.add(p, k, fromBack);
+    }else{
+      double p;
+      uint x = Q.pop(&p);
+      CHECK_EQ(x, S.first().x, "pop order differs from sorted queue");
+      CHECK_EQ(p, S.first().p, "");
+      S.pop();
+    }
+    CHECK_EQ(Q.N, S.N, "");
+  }
+  rai::Array<PriorityQueueEntry<uint>> sorted = Q.sorted();
+  for(uint i=0;i<sorted.N;i++) CHECK_EQ(sorted(i).x, S(i).x, "");
+  while(Q.N) CHECK_EQ(Q.pop(), S.pop(), "");
+}
+
+//===========================================================================
+
+template<class Queue> double throughput(uint n, uint steps){
+  //fill the queue with n open nodes, then A*-like steps: pop one, push two (one with higher p)
+  Queue Q;
+  for(uint i=0;i<n;i++) Q.add(rnd.uni(), i, true);
+  rai::timerStart();
+  for(uint i=0;i<steps;i++){
+    Q.pop();
+    Q.add(rnd.uni(), i, true);
+    Q.add(rnd.uni()+1., i, true);
+  }
+  return 1e-6*(3*steps)/rai::timerRead(); //million operations per sec
+}
+
+void TEST(Benchmark){
+  for(uint n:{10000, 100000, 1000000}){
+    cout <<"#open nodes " <<n <<": heap " <<throughput<PriorityQueue<uint>>(n, n) <<"M ops/sec";
+    if(n<=100000) cout <<", sorted array " <<throughput<SortedQueue>(n, 10000) <<"M ops/sec";
+    cout <<endl;
+  }
+}
+
+//===========================================================================
+
+int main(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testOrder();
+  testBenchmark();
+
+  return 0;
+}
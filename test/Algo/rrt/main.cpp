@@ -0,0 +1,55 @@
+#include <Core/util.h>
+#include <Algo/rrt.h>
+
+//===========================================================================
+
+double growRRT(uint N, uint dim){
+  arr q0 = zeros(dim), q, proposal;
+  RRT rrt(q0, .01);
+  rai::timerStart();
+  for(uint n=1;n<N;n++){
+    q = rand(dim);
+    rrt.getProposalTowards(proposal, q);
+    rrt.add(proposal);
+    if(!(n%200000)) cout <<"  " <<n <<" nodes: " <<rai::timerRead(false) <<"sec" <<endl;
+  }
+  CHECK_EQ(rrt.getNumberNodes(), N, "");
+  return rai::timerRead();
+}
+
+//reference: the same growth with a linear nearest neighbor scan
+double growLinear(uint N, uint dim){
+  arr X = zeros(1, dim), q, proposal;
+  rai::timerStart();
+  for(uint n=1;n<N;n++){
+    q = rand(dim);
+    uint nearest=0;
+    double dmin=INFINITY;
+    for(uint i=0;i<X.d0;i++){ double d=sqrDistance(X[i], q); if(d<dmin){ dmin=d; nearest=i; } }
+    arr d = q - X[nearest];
+    double dist = length(d);
+    proposal = (dist>.01 ? X[nearest] + .01/dist * d : q);
+    X.append(proposal);
+  }
+  return rai::timerRead();
+}
+
+void TEST(RRTGrowth){
+  uint dim=3;
+  uint N = rai::getParameter<uint>("N", 1000000);
+
+  cout <<"RRT growth to 10^4 nodes, linear scan: " <<growLinear(10000, dim) <<"sec" <<endl;
+  cout <<"RRT growth to 10^4 nodes, kd forest:   " <<growRRT(10000, dim) <<"sec" <<endl;
+  double t = growRRT(N, dim);
+  cout <<"RRT growth to " <<N <<" nodes, kd forest: " <<t <<"sec, " <<N/t <<" nodes/sec" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testRRTGrowth();
+
+  return 0;
+}
@@ -5,6 +5,8 @@
 #include <Kin/F_geometrics.h>
 #include <Kin/F_collisions.h>
 
+#include <iomanip>
+
 //===========================================================================
 
 void testMinimal(){
@@ -151,10 +153,85 @@ void testIneqCarrot(){
 
 //===========================================================================
 
+//per-cycle latency of update+solve, cold (problem rebuilt every cycle) vs. warm (persistent workspace) vs. realtime (warm, bounded iterations)
+void testLatency(){
+  double tau=.01;
+  uint T=500;
+
+  for(uint mode=0;mode<3;mode++){
+    rai::Configuration C;
+    C.addFile("scene.g");
+
+    CtrlSet CS;
+    CS.add_qControlObjective(2, 1e-2*sqrt(tau), C);
+    CS.add_qControlObjective(1, 1e-1*sqrt(tau), C);
+    CS.addObjective(make_feature(FS_poseDiff, {"gripper", "target"}, C, {1e0}), OT_sos, .1);
+    CS.addObjective(make_feature<F_AccumulatedCollisions>({"ALL"}, C, {1e0}), OT_eq);
+
+    CtrlSolver ctrl(C, tau, 2);
+    ctrl.warmStart = ctrl.komo.opt.reuseSolver = (mode>0);
+    ctrl.realtime = (mode==2);
+    if(ctrl.realtime){ ctrl.opt.stopIters=5; ctrl.opt.stopOuters=2; }
+
+    arr latency(T);
+    for(uint t=0;t<T;t++){
+      double time = -rai::realTime();
+      ctrl.set(CS);
+      arr q = C.getJointState();
+      ctrl.update(q, {}, C);
+      q = ctrl.solve();
+      latency(t) = time + rai::realTime();
+      C.setJointState(q);
+      C.stepSwift();
+    }
+
+    //-- histogram (10 bins up to the maximum) and percentiles
+    arr sorted = latency;
+    std::sort(sorted.p, sorted.p+sorted.N);
+    double max = sorted.last();
+    uintA hist = consts<uint>(0, 10);
+    for(double l:latency) hist(rai::MIN(9, int(10.*l/max)))++;
+    cout <<"--- " <<(mode==0?"cold":(mode==1?"warm":"realtime")) <<":"
+         <<" p50=" <<1e3*sorted(T/2) <<"ms p99=" <<1e3*sorted((99*T)/100) <<"ms max=" <<1e3*max <<"ms"
+         <<"  final sos=" <<ctrl.sos <<" eq=" <<ctrl.eq <<endl;
+    for(uint i=0;i<hist.N;i++) cout <<"  [" <<std::setw(6) <<1e3*max*i/10 <<"ms] " <<std::string((60*hist(i))/T, '#') <<' ' <<hist(i) <<endl;
+  }
+
+  //-- cold and warm solver in lockstep from the same states: same solutions, fewer evaluations when warm
+  rai::Configuration C;
+  C.addFile("scene.g");
+  CtrlSet CS;
+  CS.add_qControlObjective(2, 1e-2*sqrt(tau), C);
+  CS.add_qControlObjective(1, 1e-1*sqrt(tau), C);
+  CS.addObjective(make_feature(FS_poseDiff, {"gripper", "target"}, C, {1e0}), OT_sos, .1);
+  CtrlSolver cold(C, tau, 2), warm(C, tau, 2);
+  cold.warmStart = cold.komo.opt.reuseSolver = false;
+  warm.warmStart = warm.komo.opt.reuseSolver = true;
+  uint evalsCold=0, evalsWarm=0;
+  for(uint t=0;t<100;t++){
+    arr q = C.getJointState();
+    cold.set(CS);
+    cold.update(q, {}, C);
+    arr qCold = cold.solve();
+    evalsCold += rai::Configuration::setJointStateCount;
+    warm.set(CS);
+    warm.update(q, {}, C);
+    arr qWarm = warm.solve();
+    evalsWarm += rai::Configuration::setJointStateCount;
+    CHECK_ZERO(maxDiff(qCold, qWarm), 1e-3, "warm started solution differs from the cold one at t=" <<t);
+    C.setJointState(qCold);
+  }
+  cout <<"evaluations over 100 cycles: cold=" <<evalsCold <<" warm=" <<evalsWarm <<endl;
+  CHECK(evalsWarm<evalsCold, "warm starting didn't reduce the number of evaluations");
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
   testMinimal();
+  testLatency();
 //  testGrasp();
 //  testIneqCarrot();
 
@@ -1,5 +1,8 @@
 #include <Core/graph.h>
 
+#include <thread>
+#include <atomic>
+
 //const char *filename="/home/mtoussai/git/3rdHand/documents/USTT/14-meeting3TUD/box.g";
 const char *filename=nullptr;
 
@@ -132,6 +135,57 @@ void TEST(Random){
 
 //===========================================================================
 
+void TEST(KeyIndex){
+  //-- findNode(s) via the key index must equal the linear search, also after deleting and renaming nodes
+  rai::Graph G;
+  for(uint i=0;i<1000;i++) G.newNode<bool>(STRING('k' <<rnd(300)), {}, true);
+
+  for(uint k=0;k<400;k++){
+    switch(rnd(6)){
+      case 0: G.newNode<bool>(STRING('k' <<rnd(300)), {}, true); break;
+      case 1: delete G.rndElem(); break;
+      case 2: G.rndElem()->key = STRING('r' <<k); break; //rename to a new key
+      case 3: G.rndElem()->key = "renamedAway"; break;
+      case 4: G.rndElem()->key = STRING('k' <<rnd(300)); break; //rename onto a (likely) existing key
+      case 5: { rai::Node* n=G.rndElem(); n->key.clear(); n->key <<'k' <<rnd(300); } break; //same via streaming
+    }
+    for(uint j=0;j<10;j++){
+      rai::String key;
+      if(rnd.uni()<.5) key <<'k' <<rnd(300); else key <<'r' <<rnd(k+1);
+      rai::Node *n=nullptr;
+      rai::NodeL L;
+      for(rai::Node* m:G) if(m->key==key){ if(!n) n=m; L.append(m); }
+      CHECK_EQ(G.findNode(key), n, "indexed findNode differs for key " <<key);
+      CHECK_EQ(G.findNodes(key), L, "indexed findNodes differs for key " <<key);
+    }
+  }
+
+  //-- concurrent first lookups (the index is built lazily by one of the threads)
+  {
+    rai::Graph H;
+    for(uint i=0;i<1000;i++) H.newNode<bool>(STRING('k' <<i), {}, true);
+    std::vector<std::thread> threads;
+    std::atomic<uint> wrong(0);
+    for(uint t=0;t<4;t++) threads.emplace_back([&H, &wrong](){
+      for(uint i=0;i<1000;i++) if(H.findNode(STRING('k' <<i))!=H.elem(i)) wrong++;
+    });
+    for(std::thread& th:threads) th.join();
+    CHECK_EQ(wrong.load(), 0, "concurrent lookups failed");
+  }
+
+  //-- lookup time vs graph size
+  for(uint n:{1000, 10000, 100000}){
+    rai::Graph H;
+    for(uint i=0;i<n;i++) H.newNode<bool>(STRING('k' <<i), {}, true);
+    uint K=10000;
+    rai::timerStart();
+    for(uint k=0;k<K;k++) CHECK(H.findNode(STRING('k' <<rnd(n))), "");
+    cout <<"graph size " <<n <<": " <<1e6*rai::timerRead()/K <<"us per findNode" <<endl;
+  }
+}
+
+//===========================================================================
+
 void TEST(Dot){
   rai::Graph G;
   G <<FILE(filename?filename:"coffee_shop.fg");
@@ -167,6 +221,7 @@ int MAIN(int argc, char** argv){
   if(argc>1 && argv[1][0]!='-') filename=argv[1];
 
   testRandom();
+  testKeyIndex();
   testRead();
   testInit();
   testDot();
@@ -1,5 +1,7 @@
 #include <Core/thread.h>
 
+#include <iomanip>
+
 //===========================================================================
 
 // Normal Thread struct
@@ -192,6 +194,90 @@ void TEST(Logging){
 
 //===========================================================================
 
+// a 1kHz writer that publishes a largish state, and a slow reader that takes its time with each snapshot
+
+template<class V>
+struct RealtimeWriter : Thread {
+  V& x;
+  RealtimeWriter(V& _x) : Thread("RTWriter", .001), x(_x) {}
+  ~RealtimeWriter(){ threadClose(); }
+  void step(){
+    auto w = x.set();
+    w().resize(10000);
+    w()(step_count%10000) += 1.;
+  }
+};
+
+template<class V>
+struct SlowReader : Thread {
+  V& x;
+  double sum=0.;
+  SlowReader(V& _x) : Thread("SlowReader", .0), x(_x) {}
+  ~SlowReader(){ threadClose(); }
+  void step(){
+    auto r = x.get();
+    double t=rai::realTime();
+    while(rai::realTime()-t<.003) sum += ((const arr&)r).N; //hold the snapshot for 3ms
+  }
+};
+
+template<class V>
+void runRealtimeLoop(const char* name, int priority, double spinSec){
+  V x;
+  RealtimeWriter<V> w(x);
+  SlowReader<V> r(x);
+  w.setRealtime(priority, -1, spinSec);
+  r.threadLoop();
+  w.threadLoop();
+  rai::wait(2.);
+  w.threadStop(true);
+  r.threadStop(true);
+  cout <<std::setw(28) <<std::left <<name <<w.timer.report() <<" busyMax=" <<1e3*w.timer.busyDtMax <<"ms missedTics=" <<w.metronome.missedTics <<endl;
+}
+
+void TEST(RealtimeLoop){
+  //-- RTVar semantics: snapshot isolation, revisions
+  RTVar<arr> x;
+  x.set() = ARR(1., 2.);
+  {
+    auto r = x.get();
+    x.set()->append(3.);
+    CHECK_EQ(r().N, 2, "a reader's snapshot must not change while it is held");
+    CHECK_EQ(r.revision(), 1, "");
+  }
+  CHECK_EQ(x.get()().N, 3, "");
+  CHECK_EQ(x.getRevision(), 2, "");
+
+  //-- many concurrent readers on a fast writer: every snapshot must be consistent
+  RTVar<arr> y;
+  y.set() = zeros(100);
+  std::atomic<bool> stop(false);
+  std::atomic<uint> bad(0), reads(0);
+  std::vector<std::thread> readers;
+  for(uint k=0; k<3; k++) readers.emplace_back([&](){
+    while(!stop){
+      auto r = y.get();
+      const arr& a = r;
+      for(uint i=1; i<a.N; i++) if(a.elem(i)!=a.elem(0)) { bad++; break; }
+      reads++;
+    }
+  });
+  uint writes=0;
+  for(double t=rai::realTime(); rai::realTime()-t<.5; writes++){ auto w=y.set(); w() += 1.; }
+  stop=true;
+  for(auto& th:readers) th.join();
+  cout <<"RTVar: " <<writes <<" writes, " <<reads <<" concurrent reads, " <<bad <<" inconsistent" <<endl;
+  CHECK_EQ(bad, 0, "torn read");
+  CHECK_EQ(y.get()().elem(0), double(writes), "");
+
+  //-- jitter of a 1kHz writer loop with a slow reader
+  runRealtimeLoop<Var<arr>>("Var (rwlock)", 0, 0.);
+  runRealtimeLoop<RTVar<arr>>("RTVar", 0, 0.);
+  runRealtimeLoop<RTVar<arr>>("RTVar + FIFO/spin", 80, .0002);
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -201,6 +287,7 @@ int MAIN(int argc,char** argv){
   testWay0();
   testWay1();
   testLogging();
+  testRealtimeLoop();
 
   return 0;
 }
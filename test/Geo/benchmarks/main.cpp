@@ -0,0 +1,155 @@
+#include <Geo/geo.h>
+#include <Geo/depth2PointCloud.h>
+#include <Core/array.h>
+
+//===========================================================================
+//
+// micro-benchmarks of the transformation kernels (compile with SIMD=1 for AVX2/FMA)
+//
+
+#define NUM 10000000
+
+//plain reference implementation of the quaternion product
+rai::Quaternion refMult(const rai::Quaternion& b, const rai::Quaternion& c){
+  return rai::Quaternion(b.w*c.w - b.x*c.x - b.y*c.y - b.z*c.z,
+                         b.w*c.x + b.x*c.w + b.y*c.z - b.z*c.y,
+                         b.w*c.y + b.y*c.w + b.z*c.x - b.x*c.z,
+                         b.w*c.z + b.z*c.w + b.x*c.y - b.y*c.x);
+}
+
+//===========================================================================
+
+void TEST(Quaternion){
+  rai::Quaternion A, B, C, D;
+  for(uint k=0;k<100;k++){
+    B.setRandom(); C.setRandom();
+    A = B*C;
+    D = refMult(B, C);
+    CHECK_ZERO(maxDiff(A.getArr4d(), D.getArr4d()), 1e-12, "quaternion product differs");
+    D = B;
+    D.append(C);
+    CHECK_ZERO(maxDiff(A.getArr4d(), D.getArr4d()), 1e-12, "quaternion append differs");
+  }
+
+  rai::Transformation X, Y;
+  X.setRandom(); Y.setRandom();
+  rai::Vector v(.1, .2, .3), w(0);
+  double t;
+
+  B.setRandom();
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ B = B*C; }
+  t = rai::timerRead();
+  cout <<"quaternion product:     " <<1e9*t/NUM <<"ns  (" <<B <<')' <<endl;
+
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ w += B*v; }
+  t = rai::timerRead();
+  cout <<"vector rotation:        " <<1e9*t/NUM <<"ns  (" <<w <<')' <<endl;
+
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ X.appendTransformation(Y); X.rot.normalize(); }
+  t = rai::timerRead();
+  cout <<"transformation append:  " <<1e9*t/NUM <<"ns  (" <<X <<')' <<endl;
+}
+
+//===========================================================================
+
+void TEST(PointArray){
+  rai::Transformation X;
+  X.setRandom();
+  arr pts = randn(640*480, 3), ref;
+
+  //reference: the plain matrix product
+  ref = pts * ~X.rot.getArr();
+  for(uint i=0;i<ref.d0;i++) ref[i] += X.pos.getArr();
+  arr tmp = pts;
+  X.applyOnPointArray(tmp);
+  CHECK_ZERO(maxDiff(tmp, ref), 1e-10, "point array transform differs");
+
+  tmp = pts;
+  X.rot.applyOnPointArray(tmp);
+  CHECK_ZERO(maxDiff(tmp, pts * ~X.rot.getArr()), 1e-10, "point array rotation differs");
+
+  uint K=100;
+  double t;
+  rai::timerStart();
+  for(uint k=0;k<K;k++){ tmp = pts * ~X.rot.getArr(); }
+  t = rai::timerRead();
+  cout <<"point array, matrix product: " <<1e9*t/(K*pts.d0) <<"ns/point, " <<(K*pts.d0)/t <<" points/sec" <<endl;
+
+  rai::timerStart();
+  for(uint k=0;k<K;k++){ X.applyOnPointArray(pts); }
+  t = rai::timerRead();
+  cout <<"point array, transform:      " <<1e9*t/(K*pts.d0) <<"ns/point, " <<(K*pts.d0)/t <<" points/sec" <<endl;
+}
+
+//===========================================================================
+
+void TEST(DepthToPointCloud){
+  uint H=720, W=1280;
+  float f=.8*W;
+  floatA depth(H, W);
+  for(uint i=0;i<depth.N;i++) depth.elem(i) = 1.+rnd.uni();
+  for(uint i=0;i<depth.N;i+=97) depth.elem(i) = -1.; //invalid
+  rai::Transformation X;
+  X.setRandom();
+
+  //reference: scalar conversion, then transformation
+  arr ref, pts;
+  depthData2pointCloud(ref, depth, f, f, .5*W, .5*H);
+  CHECK_ZERO(maxDiff(ref(0, 0, {}), zeros(3)), 0., "invalid depths need to give zero points");
+  for(uint i:{1u, 333u, 719u}) for(uint j:{0u, 640u, 1279u}) {
+    double d = depth(i, j);
+    if(d>=0.) CHECK_ZERO(maxDiff(ref(i, j, {}), arr{d*(j-.5*W)/f, -d*(i-.5*H)/f, -d}), 1e-4, "camera-frame conversion differs");
+  }
+  X.applyOnPointArray(ref);
+
+  DepthRays rays;
+  rays.set(H, W, f, f, .5*W, .5*H);
+  floatA fpts;
+  depthData2pointCloud(fpts, depth, rays, X);
+  CHECK_ZERO(maxDiff(convert<double>(fpts), ref), 1e-4, "fused float conversion differs");
+  depthData2pointCloud(pts, depth, rays, X);
+  CHECK_ZERO(maxDiff(pts, ref), 1e-4, "fused double conversion differs");
+
+  ThreadPool pool;
+  floatA fpts2;
+  depthData2pointCloud(fpts2, depth, rays, X, &pool);
+  CHECK_ZERO(maxDiff(fpts2, fpts), 1e-10, "threaded conversion differs");
+
+  DepthRays rays2;
+  rays2.set(H, W, f, f, .5*W, .5*H, 2);
+  depthData2pointCloud(fpts2, depth, rays2, X);
+  CHECK_EQ(fpts2.d0, H/2, "");
+  CHECK_ZERO(maxDiff(fpts2(10, 20, {}), fpts(20, 40, {})), 1e-5, "strided conversion differs");
+
+  uint K=20;
+  double t;
+  rai::timerStart();
+  for(uint k=0;k<K;k++){ depthData2pointCloud(pts, depth, f, f, .5*W, .5*H); X.applyOnPointArray(pts); }
+  t = rai::timerRead();
+  cout <<"depth->points, scalar + transform: " <<1e3*t/K <<"ms/image" <<endl;
+
+  rai::timerStart();
+  for(uint k=0;k<K;k++){ depthData2pointCloud(fpts, depth, rays, X); }
+  t = rai::timerRead();
+  cout <<"depth->points, fused float:        " <<1e3*t/K <<"ms/image" <<endl;
+
+  rai::timerStart();
+  for(uint k=0;k<K;k++){ depthData2pointCloud(fpts, depth, rays, X, &pool); }
+  t = rai::timerRead();
+  cout <<"depth->points, fused float, " <<pool.size() <<" threads: " <<1e3*t/K <<"ms/image" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc,char **argv){
+  rai::initCmdLine(argc, argv);
+
+  testQuaternion();
+  testPointArray();
+  testDepthToPointCloud();
+
+  return 0;
+}
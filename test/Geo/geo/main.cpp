@@ -1,4 +1,5 @@
 #include <Geo/geo.h>
+#include <Geo/voxelGrid.h>
 #include <Core/array.h>
 
 //===========================================================================
@@ -55,11 +56,56 @@ void TEST(QuaternionJacobian){
 
 //===========================================================================
 
+void TEST(VoxelGrid){
+  //points on a regular lattice, 5 per voxel
+  double res=.1;
+  arr pts;
+  for(uint i=0;i<20;i++) for(uint j=0;j<20;j++) for(uint k=0;k<20;k++) for(uint l=0;l<5;l++){
+    pts.append({res*(i+.1+.2*l), res*(j+.5), res*(k+.5)-1.});
+  }
+  pts.reshape(-1, 3);
+
+  arr C;
+  rai::voxelFilter(C, pts, res);
+  CHECK_EQ(C.d0, 8000, "");
+  CHECK_ZERO(maxDiff(C[0], arr{.05, .05, -.95}), 1e-10, "wrong centroid");
+
+  rai::VoxelGrid grid(res);
+  grid.insert(pts);
+  CHECK_EQ(grid.count(rai::Vector(.05, .05, -.95)), 5, "");
+  CHECK(!grid.isOccupied(rai::Vector(-.05, .05, -.95)), "");
+  CHECK(!grid.isOccupied(rai::Vector(.05, .05, -.95), 6), "");
+  grid.getCenters(C);
+  CHECK_ZERO(maxDiff(C[0], arr{.05, .05, -.95}), 1e-10, "wrong center");
+
+  //incremental insertion with a min-points threshold
+  grid.insert(arr{.05, .05, -.95, 5., 5., 5.});
+  grid.getCentroids(C, 6);
+  CHECK_EQ(C.d0, 1, "");
+  grid.getRecent(C);
+  CHECK_EQ(C.d0, 2, "");
+  CHECK_EQ(grid.size(), 8001, "");
+  grid.clear();
+  CHECK_EQ(grid.size(), 0, "");
+
+  //a large cloud
+  floatA big = convert<float>(rand(900000, 3));
+  floatA out;
+  rai::timerStart();
+  rai::voxelFilter(out, big, .04);
+  double t = rai::timerRead();
+  cout <<"voxel filter: " <<big.d0 <<" -> " <<out.d0 <<" points in " <<1e3*t <<"ms" <<endl;
+  CHECK_EQ(out.d0, 15625, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
   testBasics();
   testQuaternionJacobian();
+  testVoxelGrid();
 
   return 0;
 }
@@ -119,6 +119,60 @@ void TEST(Mesh) {
   gl.watch();
 }
 
+/************ large meshes and many primitives: GPU-resident buffers and display lists ************/
+
+void drawMarkers(void*, OpenGL& gl){
+  for(uint i=0;i<1000;i++){
+    glPushMatrix();
+    glTranslatef(.1*(i%30), .1*(i/30), 0.);
+    glDrawAxes(.05);
+    glDrawSphere(.01);
+    glPopMatrix();
+  }
+}
+
+void TEST(MeshBuffers) {
+  rai::Mesh mesh;
+  mesh.setSphere(7); //327k triangles
+  mesh.C = {.8, .5, .2};
+
+  OpenGL gl("mesh buffers", 400, 400, true);
+  gl.add(glStandardLight, 0);
+  gl.add(mesh);
+  gl.add(drawMarkers, 0);
+
+  uint T=50;
+  for(uint minTris:{uint(-1), 1000u}){
+    gl.drawOptions.meshBufferMinTriangles = minTris;
+    gl.renderInBack(); //first frame uploads the buffers and compiles the display lists
+    rai::timerStart();
+    for(uint t=0;t<T;t++) gl.renderInBack();
+    double time = rai::timerRead();
+    cout <<(minTris==uint(-1)?"client arrays: ":"GPU buffers:   ") <<mesh.T.d0 <<" triangles: " <<T/time <<" frames/sec" <<endl;
+  }
+
+  //direct writes into the arrays are signalled with changed() (all Mesh methods do this) and re-uploaded
+  arr V = .5*mesh.V;
+  mesh.V = V; //same size: mesh.V keeps its memory
+  mesh.changed();
+  gl.renderInBack();
+  floatA depthFromBuffers = gl.captureDepth;
+  gl.drawOptions.meshBufferMinTriangles = uint(-1);
+  gl.renderInBack();
+  CHECK_ZERO(absMax(convert<double>(depthFromBuffers-gl.captureDepth)), 1e-6, "the GPU copy of the mesh is stale");
+
+  //debug check: a write without changed() is found by content
+  gl.drawOptions.meshBufferMinTriangles = 1000;
+  gl.drawOptions.meshBufferCheckContent = true;
+  gl.renderInBack();
+  mesh.V *= 2.;
+  gl.renderInBack();
+  depthFromBuffers = gl.captureDepth;
+  gl.drawOptions.meshBufferMinTriangles = uint(-1);
+  gl.renderInBack();
+  CHECK_ZERO(absMax(convert<double>(depthFromBuffers-gl.captureDepth)), 1e-6, "content check missed a change");
+}
+
 /************ third test ************/
 
 void TEST(Obj) {
@@ -388,6 +442,7 @@ int MAIN(int argc,char **argv){
   rai::initCmdLine(argc,argv);
 
   testTeapot();
+  testMeshBuffers();
   testOfflineRendering();
   testGrab();
   testMultipleViews();
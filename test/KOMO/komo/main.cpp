@@ -3,6 +3,7 @@
 #include <Kin/F_collisions.h>
 #include <Kin/viewer.h>
 #include <Kin/F_pose.h>
+#include <Geo/fclInterface.h>
 #include <Optim/MP_Solver.h>
 
 #include <thread>
@@ -253,6 +254,174 @@ void TEST(Threading) {
 
 //===========================================================================
 
+void TEST(ParallelFeatures) {
+  rai::Configuration C("model.g");
+  C.optimizeTree(true);
+  C.addFrame("tool", "endeff")->setShape(rai::ST_ssBox, {.1, .04, .04, .01});
+  C.addFrame("obstacle")->setShape(rai::ST_ssBox, {.2, .2, .2, .02}).setPosition({.6, -.2, .9});
+
+  KOMO komo;
+  komo.opt.verbose = 0;
+  komo.setModel(C);
+  komo.setTiming(1., 100, 10., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e1});
+  komo.addObjective({.98,1.}, FS_qItself, {}, OT_sos, {1e1}, {}, 1);
+  komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1.});
+  //one order-0 F_PairCollision instance shared by all grounded objectives of the interval
+  komo.addObjective({.5,1.}, FS_distance, {"tool", "obstacle"}, OT_ineq, {1e1});
+  komo.run_prepare(.01);
+  arr x = komo.x;
+
+  //-- serial evaluation
+  arr phi0, J0;
+  komo.opt.parallelFeatures = 0;
+  komo.mp_SparseNonFactored()->evaluate(phi0, J0, x);
+  double timeSerial = komo.timeFeaturesWall;
+  double sos0=komo.sos, eq0=komo.eq;
+
+  //-- parallel evaluation (one job per grounded objective) must be bitwise identical
+  arr phi1, J1;
+  komo.reset();
+  komo.opt.parallelFeatures = 4;
+  auto Ppar = komo.mp_SparseNonFactored();
+  Ppar->evaluate(phi1, J1, x);
+
+  cout <<"feature evaluation (" <<komo.objs.N <<" grounded objectives): serial " <<timeSerial <<"sec, parallel " <<komo.timeFeaturesWall <<"sec (per thread: " <<komo.timeFeaturesPerThread <<")" <<endl;
+  CHECK_EQ(phi0.N, phi1.N, "");
+  CHECK_ZERO(maxDiff(phi0, phi1), 0., "parallel feature evaluation differs");
+  CHECK_ZERO(maxDiff(J0.sparse().unsparse(), J1.sparse().unsparse()), 0., "parallel feature Jacobians differ");
+  CHECK_EQ(komo.sos, sos0, "");
+  CHECK_EQ(komo.eq, eq0, "");
+
+  //-- second parallel evaluation writes into the cached pattern concurrently
+  Ppar->evaluate(phi1, J1, x);
+  CHECK_ZERO(maxDiff(phi0, phi1), 0., "");
+  CHECK_ZERO(maxDiff(J0.sparse().unsparse(), J1.sparse().unsparse()), 0., "parallel Jacobian with cached pattern differs");
+
+  //-- repeated evaluations write into the cached Jacobian pattern
+  komo.opt.parallelFeatures = 0;
+  auto P = komo.mp_SparseNonFactored();
+  arr phi2, J2;
+  P->evaluate(phi2, J2, x);
+  x += .01;
+  P->evaluate(phi2, J2, x);
+  komo.mp_SparseNonFactored()->evaluate(phi1, J1, x);
+  CHECK_ZERO(maxDiff(J1.sparse().unsparse(), J2.sparse().unsparse()), 0., "Jacobian with cached pattern differs");
+}
+
+//===========================================================================
+
+void TEST(ParallelCollisions) {
+  rai::Configuration C("model.g");
+  C.optimizeTree(true);
+
+  KOMO komo;
+  komo.opt.verbose = 0;
+  komo.setModel(C);
+  komo.setTiming(1., 100, 10., 2);
+  komo.run_prepare(.1);
+
+  uint K=10;
+  komo.reset();
+  for(uint k=0; k<K; k++) komo.set_x(komo.x);
+  double wallSerial = komo.timeCollisionsWall/K;
+  uintA serial;
+  for(const rai::Proxy& p:komo.pathConfig.proxies) serial.append(TUP(p.a->ID, p.b->ID));
+
+  komo.opt.parallelCollisions = 4;
+  komo.reset();
+  komo.set_x(komo.x); //creates the broadphase copies
+  komo.timeCollisionsWall = 0.;
+  for(uint k=0; k<K; k++) komo.set_x(komo.x);
+  double wallParallel = komo.timeCollisionsWall/K;
+  uintA parallel;
+  for(const rai::Proxy& p:komo.pathConfig.proxies) parallel.append(TUP(p.a->ID, p.b->ID));
+
+  cout <<"collisions: #proxies=" <<parallel.N/2 <<" wall-time serial=" <<wallSerial <<"sec parallel=" <<wallParallel <<"sec speedup=" <<wallSerial/wallParallel <<endl;
+  CHECK(serial==parallel, "parallel collision queries differ");
+
+  //-- replacing fcl must invalidate the per-thread copies
+  komo.fcl = make_shared<rai::FclInterface>(*komo.fcl);
+  komo.set_x(komo.x);
+  CHECK(komo.fclCopiesOf==komo.fcl.get(), "");
+  komo.reset();
+  CHECK(!komo.fclCopies.N, "");
+}
+
+//===========================================================================
+
+void TEST(CoherentCollisions) {
+  rai::Configuration C("model.g");
+  C.optimizeTree(true);
+
+  KOMO komo;
+  komo.opt.verbose = 0;
+  komo.setModel(C);
+  komo.setTiming(1., 100, 10., 2);
+  komo.run_prepare(.1);
+
+  auto getPairs = [&komo]() { //order-independent: sorted pair codes
+    uintA pairs;
+    uint n = komo.pathConfig.frames.N;
+    for(const rai::Proxy& p:komo.pathConfig.proxies) pairs.append(rai::MIN(p.a->ID, p.b->ID)*n + rai::MAX(p.a->ID, p.b->ID));
+    return pairs.sort();
+  };
+
+  //-- move only the second half of the path
+  arr x = komo.x;
+  for(uint i=x.N/2; i<x.N; i++) x(i) += .2*rnd.gauss();
+
+  komo.set_x(x);
+  uintA full = getPairs();
+
+  komo.opt.coherentCollisions = 1e-6;
+  komo.reset();
+  komo.set_x(komo.x);
+  double time = komo.timeCollisions;
+  komo.set_x(x);
+  uintA coherent = getPairs();
+
+  cout <<"collisions: #proxies=" <<coherent.N <<" first query time=" <<time <<" coherent re-query time=" <<komo.timeCollisions-time <<endl;
+  CHECK(full==coherent, "coherent collision queries differ");
+}
+
+//===========================================================================
+
+void TEST(ArrayArena) {
+  rai::Configuration C("model.g");
+  C.optimizeTree(true);
+
+  KOMO komo;
+  komo.opt.verbose = 0;
+  komo.setModel(C);
+  komo.setTiming(1., 100, 10., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e1});
+  komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1.});
+  komo.run_prepare(.01);
+  arr x = komo.x;
+
+  //-- heap allocations per evaluate call, without and with the arena
+  arr phi[2], J[2];
+  for(uint k=0; k<2; k++) {
+    komo.opt.arrayArena = (k==1);
+    komo.reset();
+    auto P = komo.mp_SparseNonFactored();
+    P->evaluate(phi[k], J[k], x); //warm up: the first call fills the Jacobian pattern (and the pool)
+    uint n=20;
+    uint64_t allocs = rai::globalMemoryAllocs;
+    double time = -rai::realTime();
+    for(uint i=0; i<n; i++) P->evaluate(phi[k], J[k], x);
+    time += rai::realTime();
+    cout <<"evaluate with arena=" <<k <<": " <<double(rai::globalMemoryAllocs-allocs)/n <<" allocations/call, " <<1e3*time/n <<"ms/call" <<endl;
+  }
+  CHECK_ZERO(maxDiff(phi[0], phi[1]), 0., "arena changes the result");
+  CHECK_ZERO(maxDiff(J[0].sparse().unsparse(), J[1].sparse().unsparse()), 0., "arena changes the Jacobian");
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -263,6 +432,10 @@ int main(int argc,char** argv){
   testThin();
   testPR2();
   testThreading();
+  testParallelFeatures();
+  testParallelCollisions();
+  testCoherentCollisions();
+  testArrayArena();
 
   return 0;
 }
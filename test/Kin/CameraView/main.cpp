@@ -45,10 +45,73 @@ void TEST(CameraView){
 
 // =============================================================================
 
+void TEST(BatchRendering){
+  rai::Configuration K;
+  K.addFile("../../../../rai-robotModels/pr2/pr2.g");
+  K.addFile("../../../../rai-robotModels/objects/kitchen.g");
+  K.optimizeTree();
+
+  rai::CameraView V(K, true, 0);
+  V.renderMode = V.visuals;
+  V.addSensor("kinect", "endeffKinect", 640, 480, 580./480., -1., {.1, 50.} );
+  V.addSensor("kinectSmall", "endeffKinect", 320, 240, 1., -1., {.1, 50.} );
+  V.addSensor("kinectWide", "endeffKinect", 320, 240, .5, -1., {.1, 50.} );
+
+  uint T=100;
+  byteA image;
+  floatA depth;
+  rai::Array<byteA> images;
+  rai::Array<floatA> depths;
+
+  //-- one sensor at a time, synchronous readback
+  rai::timerStart();
+  for(uint t=0;t<T;t++){
+    for(auto& sen:V.sensors){
+      V.selectSensor(sen.name);
+      V.computeImageAndDepth(image, depth);
+    }
+  }
+  double time = rai::timerRead();
+  cout <<"sequential: " <<T/time <<" frames/sec per sensor (" <<V.sensors.N <<" sensors)" <<endl;
+
+  //-- all sensors per pass, pipelined readback
+  rai::timerStart();
+  for(uint t=0;t<T;t++) V.computeImageAndDepthAll(images, depths);
+  time = rai::timerRead();
+  cout <<"batched:    " <<T/time <<" frames/sec per sensor (" <<V.sensors.N <<" sensors)" <<endl;
+
+  //the last sensor's image is the same in both modes (up to one step latency, the configuration did not change)
+  V.computeImageAndDepthAll(images, depths, false);
+  CHECK_EQ(images.last().N, image.N, "");
+  CHECK_EQ(depths.last().N, depth.N, "");
+  double d = absMax(convert<double>(depths.last()-depth));
+  cout <<"max depth difference: " <<d <<endl;
+  CHECK_ZERO(d, 1e-6, "batched and sequential depth differ");
+
+  //-- change the scene after a pipelined call: a non-pipelined call returns the new frame, not the still pending old one
+  V.computeImageAndDepthAll(images, depths);
+  arr q = K.getJointState();
+  K.setJointState(q+.1);
+  V.updateConfiguration(K);
+  V.selectSensor(V.sensors.last().name);
+  V.computeImageAndDepth(image, depth);
+  V.computeImageAndDepthAll(images, depths, false);
+  d = absMax(convert<double>(depths.last()-depth));
+  cout <<"max depth difference after the scene changed: " <<d <<endl;
+  CHECK_ZERO(d, 1e-6, "non-pipelined call returned a stale frame");
+
+  //-- and no stale readback is left: the next pipelined call has nothing to return yet
+  V.computeImageAndDepthAll(images, depths);
+  CHECK(!images.last().N, "stale readback still pending");
+}
+
+// =============================================================================
+
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
   testCameraView();
+  testBatchRendering();
 
   return 0;
 }
@@ -3,6 +3,7 @@
 #include <Kin/viewer.h>
 #include <Kin/kin_swift.h>
 #include <Kin/kin_ode.h>
+#include <Kin/kin_packed.h>
 #include <Algo/spline.h>
 #include <Algo/algos.h>
 #include <Gui/opengl.h>
@@ -10,6 +11,8 @@
 #include <GL/gl.h>
 #include <Optim/optimization.h>
 #include <Kin/feature.h>
+#include <Kin/F_pose.h>
+#include <thread>
 
 //===========================================================================
 //
@@ -245,6 +248,201 @@ void TEST(KinematicSpeed){
 #endif
 }
 
+//===========================================================================
+//
+// incremental forward kinematics: only subtrees below changed joints are recomputed
+//
+
+void TEST(IncrementalKinematics){
+  rai::Configuration K("arm7.g");
+  uint n=K.getJointStateDimension();
+  arr q = K.getJointState();
+  K.ensure_X();
+
+  //-- change only the last joint
+  q(n-1) += .1;
+  uint count = K.calcXCount;
+  K.setJointState(q);
+  K.ensure_X();
+  uint recomputed = K.calcXCount - count;
+
+  //-- compare against full forward kinematics: all poses of a fresh configuration are invalidated and recomputed
+  rai::Configuration K2("arm7.g");
+  K2.setJointState(q);
+  uint nonRoots=0;
+  for(rai::Frame* f:K2.frames) if(f->parent) { f->set_Q() = f->get_Q(); nonRoots++; } //touching Q invalidates the frame's subtree
+  count = K2.calcXCount;
+  K2.ensure_X();
+  uint recomputedFull = K2.calcXCount - count;
+
+  cout <<"frames recomputed: incremental=" <<recomputed <<" full=" <<recomputedFull <<" (#frames=" <<K.frames.N <<")" <<endl;
+  CHECK_EQ(recomputedFull, nonRoots, "reference run did not recompute all poses");
+  CHECK(recomputed<recomputedFull, "changing the last joint should not recompute all frames");
+  for(uint i=0; i<K.frames.N; i++) {
+    CHECK_ZERO(maxDiff(K.frames(i)->getPose(), K2.frames(i)->getPose()), 1e-10, "incremental FK differs at frame '" <<K.frames(i)->name <<"'");
+  }
+
+  //-- setting the same state again recomputes nothing
+  count = K.calcXCount;
+  K.setJointState(q);
+  K.ensure_X();
+  CHECK_EQ(K.calcXCount, count, "");
+
+  //-- timing: random full changes vs single-joint changes
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ rndUniform(q,-.5,.5,false); K.setJointState(q); K.ensure_X(); }
+  cout <<"kinematics timing, all joints changed: " <<rai::timerRead() <<"sec" <<endl;
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ q(n-1) = rnd.uni(-.5,.5); K.setJointState(q); K.ensure_X(); }
+  cout <<"kinematics timing, one joint changed: " <<rai::timerRead() <<"sec" <<endl;
+}
+
+//===========================================================================
+//
+// packed (structure-of-arrays) kinematics
+//
+
+void TEST(PackedKinematics){
+  rai::Configuration K("kinematicTests.g");
+  uint n=K.getJointStateDimension();
+  rai::PackedKinematics P(K);
+  arr q(n), J, Jpacked;
+
+  for(uint k=0;k<10;k++){
+    rndUniform(q,-.5,.5,false);
+    K.setJointState(q);
+    P.fwdKinematics();
+    for(rai::Frame* f:K.frames){
+      rai::Transformation X = P.getPose(f->ID);
+      CHECK_ZERO(maxDiff(X.getArr7d(), f->ensure_X().getArr7d()), 1e-10, "packed FK differs at '" <<f->name <<"'");
+      K.jacobian_pos(J, f, f->ensure_X().pos);
+      P.jacobianPos(Jpacked, f->ID, f->ensure_X().pos);
+      CHECK_ZERO(maxDiff(J, Jpacked), 1e-10, "packed Jacobian differs at '" <<f->name <<"'");
+    }
+  }
+
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ rndUniform(q,-.5,.5,false); K.setJointState(q); K.ensure_X(); }
+  cout <<"kinematics timing, frames: " <<rai::timerRead() <<"sec" <<endl;
+  rai::timerStart();
+  for(uint k=0;k<NUM;k++){ rndUniform(q,-.5,.5,false); K.setJointState(q); P.fwdKinematics(); }
+  cout <<"kinematics timing, packed: " <<rai::timerRead() <<"sec" <<endl;
+
+  //-- fwdKinematics(q) for a q that is not the state: all joints above packed frames are computed from q
+  arr q1(n);
+  rndUniform(q1,-.5,.5,false);
+  P.fwdKinematics(q1);
+  CHECK(!P.posIsPacked(K["arm5"]->ID), "arm5 is below the (not modelled) phiTransXY joint");
+  K.setJointState(q1);
+  for(rai::Frame* f:K.frames) if(P.posIsPacked(f->ID)){
+    CHECK_ZERO(maxDiff(P.getPose(f->ID).getArr7d(), f->ensure_X().getArr7d()), 1e-10, "packed FK(q) differs at '" <<f->name <<"'");
+  }
+
+  //-- without the phiTransXY joint, the whole chain including the mimic joint is computed from q
+  rai::Configuration K2("kinematicTests.g");
+  K2.selectJoints({K2["transRot"]}, true);
+  rai::PackedKinematics P2(K2);
+  q1.resize(K2.getJointStateDimension());
+  rndUniform(q1,-.5,.5,false);
+  P2.fwdKinematics(q1);
+  K2.setJointState(q1);
+  for(rai::Frame* f:K2.frames){
+    CHECK(P2.posIsPacked(f->ID), "");
+    CHECK_ZERO(maxDiff(P2.getPose(f->ID).getArr7d(), f->ensure_X().getArr7d()), 1e-10, "packed FK(q) with mimic joint differs at '" <<f->name <<"'");
+  }
+}
+
+//===========================================================================
+
+void TEST(BatchKinematics){
+  rai::Configuration K("kinematicTests.g");
+  uint n=K.getJointStateDimension();
+  rai::Frame *a=K.frames.last();
+  arr q0=K.getJointState();
+  arr Q(200, n), Y, J, y, Ji;
+  rndUniform(Q,-.5,.5,false);
+
+  K.kinematicsPosBatch(Y, J, Q, a, NoVector, 4);
+  CHECK_ZERO(maxDiff(K.getJointState(), q0), 1e-10, "batch changed the state");
+
+  //-- positions only: the phiTransXY joint above a must still follow Q[i]
+  arr Y0;
+  K.kinematicsPosBatch(Y0, NoArr, Q, a, NoVector, 4);
+  CHECK_ZERO(maxDiff(Y0, Y), 0., "position-only batch differs");
+
+  F_Position pos;
+  arr Yf, Jf;
+  pos.evalBatch(Yf, Jf, Q, {a});
+
+  K.jacMode = K.JM_dense;
+  for(uint i=0;i<Q.d0;i++){
+    K.setJointState(Q[i]);
+    K.kinematicsPos(y, Ji, a);
+    CHECK_ZERO(maxDiff(y, Y[i]), 1e-10, "batch position differs");
+    CHECK_ZERO(maxDiff(Ji, J[i]), 1e-10, "batch Jacobian differs");
+    CHECK_ZERO(maxDiff(y, Yf[i]), 1e-10, "feature batch differs");
+    CHECK_ZERO(maxDiff(Ji, Jf[i]), 1e-10, "feature batch Jacobian differs");
+  }
+
+  Q.resize(NUM/10, n);
+  rndUniform(Q,-.5,.5,false);
+  rai::timerStart();
+  for(uint i=0;i<Q.d0;i++){ K.setJointState(Q[i]); K.kinematicsPos(y, Ji, a); }
+  cout <<"batch timing, serial: " <<rai::timerRead() <<"sec" <<endl;
+  rai::timerStart();
+  K.kinematicsPosBatch(Y, J, Q, a, NoVector, 1);
+  cout <<"batch timing, packed: " <<rai::timerRead() <<"sec" <<endl;
+  arr Y1, J1;
+  rai::timerStart();
+  K.kinematicsPosBatch(Y1, J1, Q, a, NoVector, 0);
+  cout <<"batch timing, packed all " <<std::thread::hardware_concurrency() <<" threads: " <<rai::timerRead() <<"sec" <<endl;
+  CHECK_ZERO(maxDiff(Y, Y1), 0., "multi-threaded batch differs");
+  CHECK_ZERO(maxDiff(J, J1), 0., "multi-threaded batch differs");
+}
+
+//===========================================================================
+
+void TEST(FrameNameIndex){
+  //-- setup time vs number of frames: adding named frames below named parents, then resolving names (as make_feature does)
+  for(uint n:{1000, 10000, 100000}){
+    rai::Configuration K;
+    rai::timerStart();
+    K.addFrame("f0");
+    for(uint i=1;i<n;i++) K.addFrame(STRING('f' <<i), STRING('f' <<rnd(i)));
+    double tAdd = rai::timerRead();
+
+    StringA names(1000);
+    for(rai::String& s:names) s <<'f' <<rnd(n);
+    rai::timerStart();
+    uintA ids = K.getFrameIDs(names);
+    double tLookup = rai::timerRead();
+    for(uint i=0;i<names.N;i++) CHECK_EQ(K.frames(ids(i))->name, names(i), "");
+    cout <<"#frames " <<n <<": addFrame " <<1e6*tAdd/n <<"us per frame, getFrameIDs " <<1e6*tLookup/names.N <<"us per name" <<endl;
+  }
+
+  //-- renamed and deleted frames are still found correctly
+  rai::Configuration K("kinematicTests.g");
+  rai::Frame *f = K.frames(3);
+  CHECK_EQ(K.getFrame(f->name), f, "");
+  f->name = "renamed";
+  CHECK_EQ(K.getFrame("renamed"), f, "");
+  delete K.frames(1);
+  CHECK_EQ(K.getFrame("renamed"), f, "");
+  CHECK_EQ(K.getFrame(K.frames.last()->name, true, true), K.frames.last(), "");
+
+  //-- renaming onto an existing name: getFrame returns the first (or last, if reverse) frame of that name
+  rai::Frame *g = K.frames.last();
+  g->name = "renamed";
+  CHECK_EQ(K.getFrame("renamed"), f, "");
+  CHECK_EQ(K.getFrame("renamed", true, true), g, "");
+  f->name.clear();
+  f->name <<"renamed" <<2;
+  CHECK_EQ(K.getFrame("renamed"), g, "");
+  CHECK_EQ(K.getFrame("renamed2"), f, "");
+  delete g;
+  CHECK(!K.getFrame("renamed", false), "");
+}
+
 //===========================================================================
 //
 // SWIFT and contacts test
@@ -653,6 +851,10 @@ int MAIN(int argc,char **argv){
   testKinematics();
   testQuaternionKinematics();
   testKinematicSpeed();
+  testIncrementalKinematics();
+  testPackedKinematics();
+  testBatchKinematics();
+  testFrameNameIndex();
   testFollowRedundantSequence();
   testInverseKinematics();
   //testDynamics();
@@ -296,6 +296,47 @@ void testCompound(){
 
 //===========================================================================
 
+void testRollouts(){
+  rai::Configuration C;
+  C.addFile("model.g");
+
+  rai::Simulation S(C, S._bullet, 0);
+
+  //fork 16 simulations from S
+  uint N=16, T=200;
+  double tau=.01;
+  rai::SimulationRollouts R(S, N);
+
+  //per rollout random joint velocity controls
+  arr U = .1*randn(uintA{N, T, C.getJointStateDimension()});
+  uintA frameIDs = {C["box"]->ID, C["gripper"]->ID};
+
+  arr X;
+  rai::timerStart();
+  R.run(X, U, tau, S._velocity, frameIDs);
+  double time = rai::timerRead();
+  cout <<"rollouts: " <<N <<'x' <<T <<" steps in " <<time <<"sec (" <<R.pool->size() <<" threads), X: " <<X.dim() <<endl;
+
+  //restarting from the snapshot reproduces the same trajectories
+  arr X2;
+  R.run(X2, U, tau, S._velocity, frameIDs);
+  cout <<"max difference between repeated rollouts: " <<absMax(X-X2) <<endl;
+  CHECK_ZERO(absMax(X-X2), 1e-12, "repeated rollouts from the same snapshot differ");
+
+  //equal controls for all rollouts give equal trajectories
+  R.run(X, U[0], tau, S._velocity, frameIDs);
+  double d=0.;
+  for(uint i=1;i<N;i++) d = rai::MAX(d, absMax(X[i]-X[0]));
+  cout <<"max difference between rollouts with equal controls: " <<d <<endl;
+  CHECK_ZERO(d, 1e-12, "rollouts with equal controls differ");
+
+  //the rollouts moved the box (otherwise the checks above are void)
+  arr X0 = X[0];
+  CHECK_GE(absMax(X0[T]-X0[0]), 1e-3, "rollouts didn't move");
+}
+
+//===========================================================================
+
 int main(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
@@ -306,6 +347,7 @@ int main(int argc,char **argv){
   testOpenClose();
   testGrasp();
   testCompound();
+  testRollouts();
 
   return 0;
 }
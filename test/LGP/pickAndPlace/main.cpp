@@ -77,6 +77,30 @@ void solve(){
   // }
 }
 
+void timeToFirstSolution(){
+  double t1=0.;
+  for(uint numThreads:{1, 2, 4, 8, 16, 32}){
+    rnd.seed(0);
+    rai::Configuration C;
+    generateProblem(C);
+    C.selectJointsByAtt({"base","armL","armR"});
+    C.optimizeTree();
+
+    rai::LGP_Tree lgp(C, "fol-pnp-switch.g");
+    lgp.fol.addTerminalRule("(on tray obj0) (on tray obj1) (on tray obj2)");
+    lgp.numThreads = numThreads;
+    lgp.verbose = 0;
+
+    double t = rai::realTime();
+    lgp.init();
+    for(uint k=0; k<10000 && !lgp.numFoundSolutions(); k++) lgp.step();
+    t = rai::realTime()-t;
+    if(numThreads==1) t1=t;
+    cout <<"threads: " <<numThreads <<" time to first solution: " <<t <<"sec  speedup: " <<t1/t
+         <<"  solution: " <<(lgp.numFoundSolutions()? lgp.fringe_solved.first()->getTreePathString() : rai::String("-")) <<endl;
+  }
+}
+
 void playIt(){
   rai::Configuration C;
   generateProblem(C);
@@ -109,6 +133,8 @@ int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 //  rnd.clockSeed();
 
+  if(rai::checkParameter<bool>("benchmark")){ timeToFirstSolution(); return 0; }
+
   solve();
 
   if(rai::getInteractivity())
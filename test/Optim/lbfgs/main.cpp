@@ -0,0 +1,72 @@
+#include <Optim/MP_Solver.h>
+#include <Optim/benchmarks.h>
+
+#include <iomanip>
+
+//===========================================================================
+
+shared_ptr<SolverReturn> solve(const shared_ptr<MathematicalProgram>& mp, MP_SolverID sid, const arr& x_init){
+  MP_Solver S;
+  S.setProblem(mp);
+  S.setSolver(sid);
+  S.setOptions(rai::OptOptions().set_verbose(0).set_stopTolerance(1e-5).set_stopEvals(10000).set_stopIters(10000));
+  S.setInitialization(x_init);
+  return S.solve();
+}
+
+void compare(const char* name, const shared_ptr<MathematicalProgram>& mp, const arr& x_init, double fOpt, double tol){
+  cout <<"--- " <<name <<" (dim=" <<x_init.N <<')' <<endl;
+  for(MP_SolverID sid : {MPS_newton, MPS_LBFGS}){
+    auto ret = solve(mp, sid, x_init);
+    arr g;
+    double f = Conv_MathematicalProgram_ScalarProblem(mp).scalar(g, NoArr, ret->x);
+    cout <<"  " <<std::setw(8) <<rai::Enum<MP_SolverID>(sid) <<": f=" <<f <<" evals=" <<ret->evals <<" time=" <<ret->time <<"sec" <<endl;
+    CHECK(boundCheck(ret->x, mp->bounds_lo, mp->bounds_up, 1e-10), "solution violates bounds");
+    if(sid==MPS_LBFGS) CHECK_ZERO(f-fOpt, tol, name <<": L-BFGS did not converge");
+  }
+}
+
+//===========================================================================
+
+void TEST(Benchmarks){
+  rnd.seed(0);
+
+  for(uint dim : {100, 1000}){
+    auto ros = make_shared<ScalarUnconstrainedProgram>(make_shared<ScalarFunction>(RosenbrockFunction()), dim);
+    compare("Rosenbrock", ros, consts<double>(-1., dim), 0., 1e-6);
+  }
+
+  for(uint dim : {100, 500}){
+    auto sqr = make_shared<MP_Squared>(dim, 100., true);
+    compare("RandomSquared", sqr, ones(dim), 0., 1e-6);
+  }
+
+  //box-bounded: the upper bound cuts off the minimum at x=1
+  uint dim=100;
+  auto ros = make_shared<ScalarUnconstrainedProgram>(make_shared<ScalarFunction>(RosenbrockFunction()), dim);
+  ros->bounds_lo = consts<double>(-2., dim);
+  ros->bounds_up = consts<double>(.5, dim);
+  arr x = consts<double>(-1., dim);
+  OptLBFGS lbfgs(x, RosenbrockFunction(), rai::OptOptions().set_verbose(0).set_stopTolerance(1e-6).set_stopEvals(10000).set_stopIters(10000));
+  OptLBFGS::StopCriterion stop = lbfgs.setBounds(ros->bounds_lo, ros->bounds_up).run(10000);
+  CHECK(stop!=OptLBFGS::stopCritEvals && stop!=OptLBFGS::stopCritIters, "bounded L-BFGS ran out of evaluations/iterations");
+  //the solution must satisfy the KKT conditions of the box: zero gradient for free variables,
+  //and a descent direction -g pointing out of the box (g<=0) for variables at the upper bound
+  arr g;
+  RosenbrockFunction()(g, NoArr, x);
+  for(uint i=0;i<dim;i++){
+    if(x(i)<.5-1e-6){ CHECK_ZERO(g(i), 1e-4, "free variable with nonzero gradient"); }
+    else{ CHECK_LE(g(i), 1e-6, "gradient pushes out of an active upper bound"); }
+  }
+  compare("bounded Rosenbrock", ros, consts<double>(-1., dim), lbfgs.fx, 1e-6);
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  testBenchmarks();
+
+  return 0;
+}